@@ -0,0 +1,75 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Outils partagés par les benchmarks de noyaux : mesure, comparaison aux références,
+// tableau de résultats (libellé, variante, valeurs, vérification)
+
+// Meilleur temps sur les itérations, en secondes : écarte le bruit de l'ordonnanceur
+inline double bestTime(int iterations, const std::function<void()>& work) {
+    double best = 1e9;
+    for (int i = 0; i < iterations; i++) {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Écart maximal entre deux séries d'échantillons
+template <typename T>
+int maxDifference(const T* a, const T* b, size_t count) {
+    int difference = 0;
+    for (size_t i = 0; i < count; i++) {
+        difference = std::max(difference, std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+    }
+    return difference;
+}
+
+template <typename T>
+int maxDifference(const std::vector<T>& a, const std::vector<T>& b) {
+    return maxDifference(a.data(), b.data(), std::min(a.size(), b.size()));
+}
+
+// Vérification bit à bit contre la référence scalaire ; retient si une variante a divergé
+class ExactCheck {
+public:
+    std::string operator()(bool same) {
+        allExact &= same;
+        return same ? "bit-exact" : "MISMATCH";
+    }
+    bool passed() const { return allExact; }
+
+private:
+    bool allExact = true;
+};
+
+static constexpr int BENCH_VARIANT_WIDTH = 10;
+static constexpr int BENCH_VALUE_WIDTH = 12;
+
+// En-tête : libellé sur labelWidth colonnes, variante, une colonne par valeur, vérification
+inline void printHeader(int labelWidth, const std::string& label, const std::vector<std::string>& columns) {
+    std::cout << std::left << std::setw(labelWidth) << label << std::setw(BENCH_VARIANT_WIDTH) << "variant";
+    for (const std::string& column : columns) {
+        std::cout << std::setw(BENCH_VALUE_WIDTH) << column;
+    }
+    std::cout << "check" << std::endl;
+}
+
+inline void printRow(int labelWidth, const std::string& label, const std::string& variant,
+                     const std::vector<double>& values, int precision, const std::string& check) {
+    std::cout << std::left << std::setw(labelWidth) << label << std::setw(BENCH_VARIANT_WIDTH) << variant
+              << std::fixed << std::setprecision(precision);
+    for (double value : values) {
+        std::cout << std::setw(BENCH_VALUE_WIDTH) << value;
+    }
+    std::cout << check << std::endl;
+}
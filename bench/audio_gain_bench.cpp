@@ -0,0 +1,105 @@
+#include "core/AudioKernels.h"
+#include "BenchUtil.h"
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Coût du volume dans le callback audio : noyaux de gain d'AudioKernels (gain fixe et rampe)
+// pour chaque variante prise en charge, comparés au chemin SDL (mise à zéro du bloc puis
+// SDL_MixAudioFormat au volume SDL_MIX_MAXVOLUME * gain). Traite 10 s de S16 stéréo 48 kHz
+// par blocs de la taille d'un callback. Les variantes sont vérifiées bit à bit contre le
+// scalaire ; SDL est comparé par écart maximal (128 pas de volume, arrondi différent).
+// Usage : audio_gain_bench [iterations] [frames par bloc]
+
+static constexpr int SAMPLE_RATE = 48000;
+static constexpr int SECONDS = 10;
+static constexpr size_t TOTAL_FRAMES = static_cast<size_t>(SAMPLE_RATE) * SECONDS;
+static constexpr float GAIN = 0.6f;
+
+static constexpr int PATH_WIDTH = 14;
+
+// Débit en millions d'échantillons par seconde et en multiple du temps réel
+static void printThroughput(const std::string& path, const std::string& variant, double seconds, const std::string& check) {
+    printRow(PATH_WIDTH, path, variant, {TOTAL_FRAMES * 2 / seconds / 1e6, SECONDS / seconds}, 1, check);
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    size_t blockFrames = argc > 2 ? static_cast<size_t>(std::max(16, std::atoi(argv[2]))) : 1024;
+
+    // Bruit pseudo-aléatoire pleine échelle, y compris -32768
+    std::vector<int16_t> source(TOTAL_FRAMES * 2);
+    uint32_t seed = 12345;
+    for (int16_t& sample : source) {
+        seed = seed * 1664525u + 1013904223u;
+        sample = static_cast<int16_t>(seed >> 16);
+    }
+    std::vector<int16_t> output(source.size());
+
+    // Bloc par bloc, comme dans le callback : fin de bloc plus courte si nécessaire
+    auto forEachBlock = [&](const std::function<void(const int16_t*, int16_t*, size_t)>& block) {
+        for (size_t frame = 0; frame < TOTAL_FRAMES; frame += blockFrames) {
+            block(source.data() + 2 * frame, output.data() + 2 * frame, std::min(blockFrames, TOTAL_FRAMES - frame));
+        }
+    };
+    const int32_t flatGain = static_cast<int32_t>(GAIN * 32767.0f + 0.5f) << 16;
+    // Rampe continue de 0 à 1 sur toute la durée
+    const int32_t rampStep = static_cast<int32_t>(AudioKernels::UNITY / static_cast<int64_t>(TOTAL_FRAMES));
+    auto runFlat = [&](const AudioKernels::Table& kernels) {
+        forEachBlock([&](const int16_t* src, int16_t* dst, size_t frames) {
+            kernels.gainRamp(src, dst, frames, flatGain, 0);
+        });
+    };
+    auto runRamp = [&](const AudioKernels::Table& kernels) {
+        forEachBlock([&](const int16_t* src, int16_t* dst, size_t frames) {
+            size_t first = (src - source.data()) / 2;
+            kernels.gainRamp(src, dst, frames, static_cast<int32_t>(first) * rampStep, rampStep);
+        });
+    };
+
+    const AudioKernels::Table scalar = AudioKernels::forIsa(AudioKernels::Isa::Scalar);
+    runFlat(scalar);
+    std::vector<int16_t> refFlat = output;
+    runRamp(scalar);
+    std::vector<int16_t> refRamp = output;
+
+    std::cout << SECONDS << " s of S16 stereo at " << SAMPLE_RATE << " Hz in blocks of " << blockFrames
+              << " frames, gain " << GAIN << ", best of " << iterations << " iterations, runtime selection: "
+              << PixelKernels::isaName(AudioKernels::best().isa) << std::endl;
+    printHeader(PATH_WIDTH, "path", {"Msamples/s", "x realtime"});
+
+    ExactCheck exact;
+
+    for (AudioKernels::Isa isa : {AudioKernels::Isa::Scalar, AudioKernels::Isa::SSE2, AudioKernels::Isa::NEON}) {
+        const AudioKernels::Table kernels = AudioKernels::forIsa(isa);
+        if (kernels.isa != isa) {
+            continue;
+        }
+        const char* name = PixelKernels::isaName(isa);
+        double seconds = bestTime(iterations, [&]() { runFlat(kernels); });
+        printThroughput("gain", name, seconds, exact(output == refFlat));
+        seconds = bestTime(iterations, [&]() { runRamp(kernels); });
+        printThroughput("gain ramp", name, seconds, exact(output == refRamp));
+    }
+
+    // Chemin SDL : deux passes sur le bloc, volume quantifié sur 128 pas, pas de rampe possible
+    const int sdlVolume = static_cast<int>(SDL_MIX_MAXVOLUME * GAIN);
+    double seconds = bestTime(iterations, [&]() {
+        forEachBlock([&](const int16_t* src, int16_t* dst, size_t frames) {
+            memset(dst, 0, frames * 2 * sizeof(int16_t));
+            SDL_MixAudioFormat(reinterpret_cast<Uint8*>(dst), reinterpret_cast<const Uint8*>(src), AUDIO_S16SYS,
+                               static_cast<Uint32>(frames * 2 * sizeof(int16_t)), sdlVolume);
+        });
+    });
+    printThroughput("SDL mix", "sdl", seconds, "max diff " + std::to_string(maxDifference(output, refFlat)));
+
+    return exact.passed() ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+#include "core/VideoDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Compare le débit du pipeline de décodage vidéo selon le mode de threading.
+// Usage : decode_threading_bench <video_file> [frames]
+
+static double measureDecodeFps(const std::string& path, DecoderThreading threading, int frames, int& threadCount) {
+    DecoderConfig config;
+    config.threading = threading;
+
+    VideoDecoder decoder;
+    decoder.setConfig(config);
+    if (!decoder.initialize(path)) {
+        return -1.0;
+    }
+    threadCount = decoder.getCodecContext()->thread_count;
+    decoder.startDecoding();
+
+    // La première frame absorbe le démarrage des threads et n'est pas comptée
+    AVFrame* frame = decoder.getNextFrame(std::chrono::milliseconds(5000));
+    if (!frame) {
+        return -1.0;
+    }
+    av_frame_free(&frame);
+
+    int decoded = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (decoded < frames) {
+        frame = decoder.getNextFrame(std::chrono::milliseconds(5000));
+        if (!frame) {
+            break;
+        }
+        av_frame_free(&frame);
+        decoded++;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    decoder.stopDecoding();
+
+    return decoded / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <video_file> [frames]" << std::endl;
+        return 1;
+    }
+    int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 300;
+
+    struct Result {
+        DecoderThreading threading;
+        int threads;
+        double fps;
+    };
+    std::vector<Result> results;
+    for (DecoderThreading threading : {DecoderThreading::Off, DecoderThreading::Slice,
+                                       DecoderThreading::Frame, DecoderThreading::Auto}) {
+        int threads = 0;
+        double fps = measureDecodeFps(argv[1], threading, frames, threads);
+        results.push_back({threading, threads, fps});
+    }
+
+    double baseline = results.front().fps;
+    std::cout << std::endl << "Decode throughput over " << frames << " frames:" << std::endl;
+    std::cout << std::left << std::setw(10) << "mode" << std::setw(10) << "threads"
+              << std::setw(12) << "fps" << "speedup" << std::endl;
+    for (const Result& result : results) {
+        std::cout << std::left << std::setw(10) << VideoDecoder::threadingName(result.threading)
+                  << std::setw(10) << result.threads;
+        if (result.fps < 0) {
+            std::cout << "failed" << std::endl;
+            continue;
+        }
+        std::cout << std::setw(12) << std::fixed << std::setprecision(1) << result.fps;
+        if (baseline > 0) {
+            std::cout << std::setprecision(2) << result.fps / baseline << "x";
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
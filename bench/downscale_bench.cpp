@@ -0,0 +1,139 @@
+#include "core/VideoDecoder.h"
+#include "core/FrameConverter.h"
+#include "core/FrameScaler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Compare le coût par frame de l'envoi à la résolution source et après réduction
+// (filtre boîte 2:1, swscale mono et multithreadé). L'envoi est simulé par la copie
+// des plans dans un tampon contigu, comme le fait SDL_UpdateYUVTexture vers une texture streaming.
+// Usage : downscale_bench <video_file> [frames] [WxH]   (taille par défaut : moitié de la source)
+
+struct PathResult {
+    const char* name;
+    int width = 0;
+    int height = 0;
+    double scaleMs = 0.0;
+    double uploadMs = 0.0;
+    double uploadMegabytes = 0.0;
+    int frames = 0;
+};
+
+// scaler nul : frames envoyées à la résolution source
+static bool measurePath(const std::string& path, FrameScaler* scaler, int frames, PathResult& result) {
+    VideoDecoder decoder;
+    if (!decoder.initialize(path)) {
+        return false;
+    }
+    decoder.startDecoding();
+
+    std::vector<uint8_t> staging;
+    using Clock = std::chrono::steady_clock;
+    std::chrono::duration<double, std::milli> scaleTime(0), uploadTime(0);
+    size_t uploadedBytes = 0;
+    while (result.frames < frames) {
+        AVFrame* frame = decoder.getNextFrame(std::chrono::milliseconds(5000));
+        if (!frame) {
+            break;
+        }
+
+        auto start = Clock::now();
+        if (scaler) {
+            scaler->scale(frame);
+        }
+        auto scaled = Clock::now();
+        uploadedBytes += FrameConverter::copyPlanes(frame, staging);
+        auto uploaded = Clock::now();
+
+        scaleTime += scaled - start;
+        uploadTime += uploaded - scaled;
+        result.width = frame->width;
+        result.height = frame->height;
+        result.frames++;
+        av_frame_free(&frame);
+    }
+    decoder.stopDecoding();
+
+    if (result.frames == 0) {
+        return false;
+    }
+    result.scaleMs = scaleTime.count() / result.frames;
+    result.uploadMs = uploadTime.count() / result.frames;
+    result.uploadMegabytes = uploadedBytes / (1024.0 * 1024.0) / result.frames;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <video_file> [frames] [WxH]" << std::endl;
+        return 1;
+    }
+    int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 300;
+
+    int targetWidth = 0, targetHeight = 0;
+    if (argc > 3) {
+        std::string size = argv[3];
+        size_t separator = size.find('x');
+        if (separator != std::string::npos) {
+            targetWidth = std::atoi(size.substr(0, separator).c_str());
+            targetHeight = std::atoi(size.substr(separator + 1).c_str());
+        }
+    }
+    if (targetWidth <= 0 || targetHeight <= 0) {
+        VideoDecoder probe;
+        if (!probe.initialize(argv[1])) {
+            return 1;
+        }
+        targetWidth = probe.getCodecContext()->width / 2;
+        targetHeight = probe.getCodecContext()->height / 2;
+    }
+
+    FrameScaler box;
+    box.setTarget(targetWidth, targetHeight);
+    FrameScaler threaded;
+    threaded.setTarget(targetWidth, targetHeight);
+    threaded.setHalfBoxEnabled(false);
+    FrameScaler single;
+    single.setTarget(targetWidth, targetHeight, 1);
+    single.setHalfBoxEnabled(false);
+
+    struct Candidate {
+        const char* name;
+        FrameScaler* scaler;
+    };
+    std::vector<PathResult> results;
+    for (const Candidate& candidate : {Candidate{"source", nullptr}, Candidate{"box", &box},
+                                       Candidate{"sws-mt", &threaded}, Candidate{"sws-1", &single}}) {
+        PathResult result;
+        result.name = candidate.name;
+        if (!measurePath(argv[1], candidate.scaler, frames, result)) {
+            result.frames = 0;
+        }
+        // Le filtre boîte ne s'applique qu'au rapport exact 2:1 sur yuv420p/nv12
+        if (candidate.scaler == &box && box.getPath() != FrameScaler::Path::HalfBox) {
+            result.name = "box (n/a)";
+        }
+        results.push_back(result);
+    }
+
+    std::cout << std::endl << "Per-frame cost over " << frames << " frames, target " << targetWidth << "x"
+              << targetHeight << ":" << std::endl;
+    std::cout << std::left << std::setw(12) << "path" << std::setw(12) << "size" << std::setw(12) << "scale ms"
+              << std::setw(12) << "upload ms" << std::setw(12) << "total ms" << "upload MB" << std::endl;
+    for (const PathResult& result : results) {
+        std::cout << std::left << std::setw(12) << result.name;
+        if (result.frames == 0) {
+            std::cout << "failed" << std::endl;
+            continue;
+        }
+        std::cout << std::setw(12) << (std::to_string(result.width) + "x" + std::to_string(result.height))
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << result.scaleMs << std::setw(12) << result.uploadMs
+                  << std::setw(12) << result.scaleMs + result.uploadMs << result.uploadMegabytes << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "core/VideoDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// Mesure l'écart entre frames à la transition de boucle, comparé à l'écart moyen,
+// en consommant les frames à la cadence du fichier comme le ferait le Renderer.
+// Usage : loop_gap_bench <video_file> [loops]
+
+static bool measureLoopGap(const std::string& path, LoopMode mode, int loops, VideoDecoder::LoopStats& stats) {
+    DecoderConfig config;
+    config.loopMode = mode;
+
+    VideoDecoder decoder;
+    decoder.setConfig(config);
+    if (!decoder.initialize(path)) {
+        return false;
+    }
+
+    AVRational frameRate = av_guess_frame_rate(nullptr, decoder.getVideoStream(), nullptr);
+    double frameSeconds = frameRate.num > 0 ? av_q2d(av_inv_q(frameRate)) : 1.0 / 30.0;
+    auto frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(frameSeconds));
+
+    decoder.startDecoding();
+    auto nextFrameTime = std::chrono::steady_clock::now();
+    while (decoder.getLoopStats().loops < static_cast<uint64_t>(loops)) {
+        AVFrame* frame = decoder.getNextFrame(std::chrono::milliseconds(5000));
+        if (!frame) {
+            decoder.stopDecoding();
+            return false;
+        }
+        av_frame_free(&frame);
+
+        nextFrameTime += frameInterval;
+        std::this_thread::sleep_until(nextFrameTime);
+    }
+    stats = decoder.getLoopStats();
+    decoder.stopDecoding();
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <video_file> [loops]" << std::endl;
+        return 1;
+    }
+    int loops = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+
+    std::cout << std::left << std::setw(10) << "mode" << std::setw(18) << "avg gap (ms)"
+              << std::setw(20) << "last loop gap (ms)" << "max loop gap (ms)" << std::endl;
+    for (LoopMode mode : {LoopMode::Seek, LoopMode::Gapless, LoopMode::Cache}) {
+        VideoDecoder::LoopStats stats{};
+        std::cout << std::left << std::setw(10) << VideoDecoder::loopModeName(mode);
+        if (!measureLoopGap(argv[1], mode, loops, stats)) {
+            std::cout << "failed" << std::endl;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(2) << std::setw(18) << stats.averageFrameGapMs
+                  << std::setw(20) << stats.lastBoundaryGapMs << stats.maxBoundaryGapMs << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include "core/PixelKernels.h"
+#include "BenchUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include <libavutil/frame.h>
+    #include <libswscale/swscale.h>
+}
+
+// Débit des noyaux de conversion de PixelKernels sur une frame 4K synthétique, pour chaque
+// variante prise en charge par le processeur, comparé à swscale pour la même conversion.
+// Chaque variante est vérifiée bit à bit contre la version scalaire ; swscale est comparé
+// par écart maximal (il arrondit et tramme différemment, notamment en 10 bits).
+// Usage : pixel_kernels_bench [iterations]
+
+static constexpr int WIDTH = 3840;
+static constexpr int HEIGHT = 2160;
+static constexpr int CHROMA_WIDTH = WIDTH / 2;
+static constexpr int CHROMA_HEIGHT = HEIGHT / 2;
+
+static constexpr int KERNEL_WIDTH = 18;
+
+// Débit en Go/s, octets lus et écrits
+static void printThroughput(const std::string& kernel, const std::string& variant, double bytes, double seconds,
+                            const std::string& check) {
+    printRow(KERNEL_WIDTH, kernel, variant, {bytes / seconds / 1e9}, 2, check);
+}
+
+// Plans d'une frame swscale recopiés ligne à ligne dans un tampon contigu
+static void copyPlane(const AVFrame* frame, int plane, int rowBytes, int rows, uint8_t* dst) {
+    for (int y = 0; y < rows; y++) {
+        memcpy(dst + static_cast<size_t>(y) * rowBytes,
+               frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane], rowBytes);
+    }
+}
+
+static void fillPlane(AVFrame* frame, int plane, int rowBytes, int rows, const uint8_t* src) {
+    for (int y = 0; y < rows; y++) {
+        memcpy(frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane],
+               src + static_cast<size_t>(y) * rowBytes, rowBytes);
+    }
+}
+
+static AVFrame* allocateFrame(AVPixelFormat format) {
+    AVFrame* frame = av_frame_alloc();
+    if (!frame) {
+        return nullptr;
+    }
+    frame->format = format;
+    frame->width = WIDTH;
+    frame->height = HEIGHT;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+    }
+    return frame;
+}
+
+// Temps d'une conversion swscale frame entière ; négatif si le contexte ne peut être créé
+static double timeSwscale(int iterations, AVFrame* source, AVFrame* output) {
+    SwsContext* context = sws_getContext(WIDTH, HEIGHT, static_cast<AVPixelFormat>(source->format),
+                                         WIDTH, HEIGHT, static_cast<AVPixelFormat>(output->format),
+                                         SWS_POINT, nullptr, nullptr, nullptr);
+    if (!context) {
+        return -1.0;
+    }
+    double seconds = bestTime(iterations, [&]() {
+        sws_scale(context, source->data, source->linesize, 0, HEIGHT, output->data, output->linesize);
+    });
+    sws_freeContext(context);
+    return seconds;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+
+    const size_t lumaSize = static_cast<size_t>(WIDTH) * HEIGHT;
+    const size_t chromaSize = static_cast<size_t>(CHROMA_WIDTH) * CHROMA_HEIGHT;
+
+    // Contenu pseudo-aléatoire couvrant toute la plage, y compris hors plage limitée
+    std::vector<uint16_t> luma10(lumaSize);
+    std::vector<uint8_t> luma(lumaSize);
+    std::vector<uint8_t> interleaved(2 * chromaSize);
+    uint32_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 16;
+    };
+    for (size_t i = 0; i < lumaSize; i++) {
+        luma10[i] = static_cast<uint16_t>(next() & 0x3FF);
+        luma[i] = static_cast<uint8_t>(next());
+    }
+    for (uint8_t& value : interleaved) {
+        value = static_cast<uint8_t>(next());
+    }
+    std::vector<uint8_t> planeU(chromaSize), planeV(chromaSize);
+    PixelKernels::forIsa(PixelKernels::Isa::Scalar).deinterleave(interleaved.data(), planeU.data(), planeV.data(),
+                                                                 chromaSize);
+
+    // Références scalaires
+    const PixelKernels::Table scalar = PixelKernels::forIsa(PixelKernels::Isa::Scalar);
+    std::vector<uint8_t> refDownshift(lumaSize), refLimited(lumaSize), refFull(lumaSize), refInterleaved(2 * chromaSize);
+    std::vector<uint8_t> refLimitedU(chromaSize), refFullU(chromaSize);
+    scalar.downshift10(luma10.data(), refDownshift.data(), lumaSize);
+    scalar.fullToLimited(luma.data(), refLimited.data(), lumaSize, false);
+    scalar.limitedToFull(luma.data(), refFull.data(), lumaSize, false);
+    scalar.fullToLimited(planeU.data(), refLimitedU.data(), chromaSize, true);
+    scalar.limitedToFull(planeU.data(), refFullU.data(), chromaSize, true);
+    scalar.interleave(planeU.data(), planeV.data(), refInterleaved.data(), chromaSize);
+
+    // La référence elle-même : bornes de la plage limitée et neutre chroma conservé
+    const uint8_t bounds[] = {0, 128, 255};
+    uint8_t lumaBounds[3], chromaBounds[3];
+    scalar.fullToLimited(bounds, lumaBounds, 3, false);
+    scalar.fullToLimited(bounds, chromaBounds, 3, true);
+    bool boundsExact = lumaBounds[0] == 16 && lumaBounds[2] == 235 &&
+                       chromaBounds[0] == 16 && chromaBounds[1] == 128 && chromaBounds[2] == 240;
+    if (!boundsExact) {
+        std::cerr << "full->limited reference misses the limited range bounds" << std::endl;
+    }
+
+    std::cout << "Frame " << WIDTH << "x" << HEIGHT << ", best of " << iterations << " iterations, "
+              << "runtime selection: " << PixelKernels::isaName(PixelKernels::best().isa) << std::endl;
+    printHeader(KERNEL_WIDTH, "kernel", {"GB/s"});
+
+    std::vector<uint8_t> out(lumaSize), outU(chromaSize), outV(chromaSize), outInterleaved(2 * chromaSize);
+    ExactCheck exact;
+
+    // Débit compté en octets lus + écrits
+    for (PixelKernels::Isa isa : {PixelKernels::Isa::Scalar, PixelKernels::Isa::SSE2, PixelKernels::Isa::AVX2,
+                                  PixelKernels::Isa::NEON}) {
+        if (!PixelKernels::isSupported(isa)) {
+            continue;
+        }
+        const PixelKernels::Table kernels = PixelKernels::forIsa(isa);
+        const char* name = PixelKernels::isaName(isa);
+
+        double seconds = bestTime(iterations, [&]() { kernels.downshift10(luma10.data(), out.data(), lumaSize); });
+        printThroughput("downshift10", name, 3.0 * lumaSize, seconds, exact(out == refDownshift));
+
+        seconds = bestTime(iterations, [&]() {
+            kernels.deinterleave(interleaved.data(), outU.data(), outV.data(), chromaSize);
+        });
+        printThroughput("nv12->i420 uv", name, 4.0 * chromaSize, seconds,
+                 exact(outU == planeU && outV == planeV));
+
+        seconds = bestTime(iterations, [&]() {
+            kernels.interleave(planeU.data(), planeV.data(), outInterleaved.data(), chromaSize);
+        });
+        printThroughput("i420->nv12 uv", name, 4.0 * chromaSize, seconds, exact(outInterleaved == refInterleaved));
+
+        seconds = bestTime(iterations, [&]() { kernels.fullToLimited(luma.data(), out.data(), lumaSize, false); });
+        printThroughput("full->limited", name, 2.0 * lumaSize, seconds, exact(out == refLimited));
+
+        seconds = bestTime(iterations, [&]() { kernels.limitedToFull(luma.data(), out.data(), lumaSize, false); });
+        printThroughput("limited->full", name, 2.0 * lumaSize, seconds, exact(out == refFull));
+
+        seconds = bestTime(iterations, [&]() { kernels.fullToLimited(planeU.data(), outU.data(), chromaSize, true); });
+        printThroughput("full->limited uv", name, 2.0 * chromaSize, seconds, exact(outU == refLimitedU));
+
+        seconds = bestTime(iterations, [&]() { kernels.limitedToFull(planeU.data(), outU.data(), chromaSize, true); });
+        printThroughput("limited->full uv", name, 2.0 * chromaSize, seconds, exact(outU == refFullU));
+    }
+
+    // swscale sur les mêmes plans (frame entière, donc les trois plans sont convertis)
+    AVFrame* source10 = allocateFrame(AV_PIX_FMT_YUV420P10LE);
+    AVFrame* sourceNv12 = allocateFrame(AV_PIX_FMT_NV12);
+    AVFrame* sourcePlanar = allocateFrame(AV_PIX_FMT_YUV420P);
+    AVFrame* sourceFull = allocateFrame(AV_PIX_FMT_YUVJ420P);
+    AVFrame* outputPlanar = allocateFrame(AV_PIX_FMT_YUV420P);
+    AVFrame* outputNv12 = allocateFrame(AV_PIX_FMT_NV12);
+    if (!source10 || !sourceNv12 || !sourcePlanar || !sourceFull || !outputPlanar || !outputNv12) {
+        std::cerr << "Failed to allocate swscale frames" << std::endl;
+        return 1;
+    }
+    std::vector<uint16_t> chroma10(chromaSize, 512);
+    fillPlane(source10, 0, WIDTH * 2, HEIGHT, reinterpret_cast<const uint8_t*>(luma10.data()));
+    fillPlane(source10, 1, CHROMA_WIDTH * 2, CHROMA_HEIGHT, reinterpret_cast<const uint8_t*>(chroma10.data()));
+    fillPlane(source10, 2, CHROMA_WIDTH * 2, CHROMA_HEIGHT, reinterpret_cast<const uint8_t*>(chroma10.data()));
+    fillPlane(sourceNv12, 0, WIDTH, HEIGHT, luma.data());
+    fillPlane(sourceNv12, 1, WIDTH, CHROMA_HEIGHT, interleaved.data());
+    for (AVFrame* frame : {sourcePlanar, sourceFull}) {
+        fillPlane(frame, 0, WIDTH, HEIGHT, luma.data());
+        fillPlane(frame, 1, CHROMA_WIDTH, CHROMA_HEIGHT, planeU.data());
+        fillPlane(frame, 2, CHROMA_WIDTH, CHROMA_HEIGHT, planeV.data());
+    }
+
+    auto reportSwscale = [](const char* kernel, double bytes, double seconds, int difference) {
+        if (seconds < 0) {
+            std::cout << std::left << std::setw(KERNEL_WIDTH) << kernel << std::setw(BENCH_VARIANT_WIDTH) << "swscale"
+                      << "unavailable" << std::endl;
+            return;
+        }
+        printThroughput(kernel, "swscale", bytes, seconds, "max diff " + std::to_string(difference));
+    };
+
+    double seconds = timeSwscale(iterations, source10, outputPlanar);
+    copyPlane(outputPlanar, 0, WIDTH, HEIGHT, out.data());
+    reportSwscale("downshift10", 3.0 * (lumaSize + 2 * chromaSize), seconds,
+                  maxDifference(out.data(), refDownshift.data(), lumaSize));
+
+    seconds = timeSwscale(iterations, sourceNv12, outputPlanar);
+    copyPlane(outputPlanar, 1, CHROMA_WIDTH, CHROMA_HEIGHT, outU.data());
+    copyPlane(outputPlanar, 2, CHROMA_WIDTH, CHROMA_HEIGHT, outV.data());
+    reportSwscale("nv12->i420", 2.0 * (lumaSize + 2 * chromaSize), seconds,
+                  std::max(maxDifference(outU.data(), planeU.data(), chromaSize),
+                           maxDifference(outV.data(), planeV.data(), chromaSize)));
+
+    seconds = timeSwscale(iterations, sourcePlanar, outputNv12);
+    copyPlane(outputNv12, 1, WIDTH, CHROMA_HEIGHT, outInterleaved.data());
+    reportSwscale("i420->nv12", 2.0 * (lumaSize + 2 * chromaSize), seconds,
+                  maxDifference(outInterleaved.data(), refInterleaved.data(), 2 * chromaSize));
+
+    // yuvj420p vers yuv420p : swscale compresse la plage au passage
+    seconds = timeSwscale(iterations, sourceFull, outputPlanar);
+    copyPlane(outputPlanar, 0, WIDTH, HEIGHT, out.data());
+    copyPlane(outputPlanar, 1, CHROMA_WIDTH, CHROMA_HEIGHT, outU.data());
+    reportSwscale("full->limited", 2.0 * (lumaSize + 2 * chromaSize), seconds,
+                  std::max(maxDifference(out.data(), refLimited.data(), lumaSize),
+                           maxDifference(outU.data(), refLimitedU.data(), chromaSize)));
+
+    for (AVFrame* frame : {source10, sourceNv12, sourcePlanar, sourceFull, outputPlanar, outputNv12}) {
+        av_frame_free(&frame);
+    }
+
+    if (!boundsExact || !exact.passed()) {
+        std::cerr << "SIMD kernels differ from the scalar reference" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,23 +1,30 @@
 #include "VideoPlayer.h"
 #include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include "utils/Tracer.h"
 #include <signal.h>
 #include <algorithm>
 #include <thread>
+#include <future>
 
-static VideoPlayer* g_player = nullptr;
+// Signal d'arrêt reçu ; le thread principal arrête la lecture depuis sa boucle
+static volatile sig_atomic_t g_stopSignal = 0;
 
 static void signal_handler(int signum) {
-    if (g_player) {
-        Logger::logInfo("Received signal " + std::to_string(signum) + ", stopping playback...");
-        g_player->stop();
-        std::exit(0);
-    }
+    g_stopSignal = signum;
+}
+
+// Export de trace à la demande : le thread principal écrit le fichier
+static void trace_signal_handler(int) {
+    Tracer::requestDump();
 }
 
-VideoPlayer::VideoPlayer() : isRunning(false), isDecodingFinished(false), paused(false), volume(100), shouldReset(false), wsController(this) {
-    g_player = this;
+VideoPlayer::VideoPlayer() : rendererBackend(RendererBackend::Sdl), wsController(this), isRunning(false), isDecodingFinished(false),
+      paused(false), volume(100), shouldReset(false), firstFramePresented(false), frameLimit(0), renderedFrames(0),
+      pendingFrame(nullptr), presenting(false), traceSeconds(DEFAULT_TRACE_SECONDS) {
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    signal(SIGUSR1, trace_signal_handler);
 }
 
 VideoPlayer::~VideoPlayer() {
@@ -25,25 +32,64 @@ VideoPlayer::~VideoPlayer() {
 }
 
 bool VideoPlayer::initialize(const std::string& videoPath, uint16_t wsPort) {
-    // Initialize SDL first
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
+    using Clock = StartupTimeline::Clock;
+
+    // L'ouverture du fichier et le serveur WebSocket s'initialisent pendant que
+    // le thread principal initialise SDL, qui doit rester sur ce thread
+    std::future<bool> decoderReady = std::async(std::launch::async, [this, videoPath]() {
+        auto start = Clock::now();
+        bool initialized = decoder.initialize(videoPath, &startupTimeline);
+        startupTimeline.record("decoder init", start);
+        return initialized;
+    });
+    std::future<bool> wsReady = std::async(std::launch::async, [this, wsPort]() {
+        auto start = Clock::now();
+        bool initialized = wsController.initialize("0.0.0.0", wsPort);
+        startupTimeline.record("WebSocket init", start);
+        return initialized;
+    });
+
+    // Sans écran, le pilote vidéo factice garde la boucle d'événements SDL
+    bool headless = rendererBackend == RendererBackend::Null;
+    if (headless && !SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy")) {
+        Logger::logError("Failed to set dummy video driver hint");
+    }
+
+    auto start = Clock::now();
+    if (SDL_Init(headless ? SDL_INIT_VIDEO : SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         Logger::logError("SDL initialization failed: " + std::string(SDL_GetError()));
         return false;
     }
+    startupTimeline.record("SDL init", start);
 
-    if (!decoder.initialize(videoPath)) {
+    if (!decoderReady.get()) {
         Logger::logError("Failed to initialize decoder");
         return false;
     }
 
-    if (!renderer.initialize(decoder.getCodecContext()->width, 
-                           decoder.getCodecContext()->height)) {
-        Logger::logError("Failed to initialize renderer");
-        return false;
+    // La fenêtre est plein écran : les frames n'ont pas besoin de dépasser la taille de l'écran
+    SDL_DisplayMode displayMode;
+    if (decoder.getConfig().downscaleToDisplay && headless) {
+        Logger::logInfo("No display with the null renderer, frames keep the source resolution");
+    } else if (decoder.getConfig().downscaleToDisplay) {
+        if (!wallConfig.tiles.empty()) {
+            Logger::logInfo("Wall tiles are given in source pixels, frames keep the source resolution");
+        } else if (SDL_GetDesktopDisplayMode(0, &displayMode) == 0) {
+            // Une grille couvre autant d'écrans que de tuiles
+            decoder.setDownscaleSize(displayMode.w * std::max(1, wallConfig.columns),
+                                     displayMode.h * std::max(1, wallConfig.rows));
+        } else {
+            Logger::logError("Could not read the display size, frames keep the source resolution: " +
+                             std::string(SDL_GetError()));
+        }
     }
 
     // Initialize audio if stream exists
-    if (decoder.getAudioStream()) {
+    start = Clock::now();
+    if (headless) {
+        // Sans présentation cadencée, l'audio n'a pas d'horloge à suivre
+        Logger::logInfo("Null renderer: audio is not played");
+    } else if (decoder.getAudioStream()) {
         Logger::logInfo("Audio stream found, initializing audio...");
         decoder.setAudioManager(&audioManager);
         if (!audioManager.initialize(decoder.getAudioCodecContext(), decoder.getAudioStream())) {
@@ -54,84 +100,278 @@ bool VideoPlayer::initialize(const std::string& videoPath, uint16_t wsPort) {
     } else {
         Logger::logInfo("No audio stream found");
     }
+    startupTimeline.record("audio init", start);
+
+    // Le décodage démarre avant la création de la fenêtre : les premières frames
+    // se décodent pendant l'initialisation du rendu
+    auto decodingStart = Clock::now();
+    isRunning = true;
+    decoder.startDecoding();
+
+    latePolicy.setFrameDuration(decoder.getFrameDuration());
+    scheduler.setFrameDuration(decoder.getFrameDuration());
+    scheduler.setAudioManager(&audioManager);
+
+    int outputWidth, outputHeight;
+    decoder.getOutputSize(outputWidth, outputHeight);
+    std::promise<bool> rendererReady;
+    std::future<bool> rendererInitialized = rendererReady.get_future();
+    renderThread = std::thread(&VideoPlayer::renderThreadFunction, this,
+                               std::move(rendererReady), outputWidth, outputHeight);
+    renderThreadId = renderThread.get_id();
+    if (!rendererInitialized.get()) {
+        Logger::logError("Failed to initialize renderer");
+        return false;
+    }
 
-    // Initialiser le WebSocketController
-    if (!wsController.initialize("0.0.0.0", wsPort)) {
+    if (!wsReady.get()) {
         Logger::logError("Failed to initialize WebSocket controller");
         return false;
     }
 
     // Démarrer le WebSocketController dans un thread séparé
     std::thread wsThread([this]() {
+        ThreadCpuScope cpuScope("websocket");
         wsController.start();
     });
     wsThread.detach();  // Détacher le thread pour qu'il s'exécute en arrière-plan
 
-    isRunning = true;
-    decoder.startDecoding();
-    
+    // La présentation commence dès que quelques frames sont prêtes, plutôt qu'après un délai fixe
+    decoder.waitForStartupFrames(std::chrono::seconds(2));
+    startupTimeline.record("buffer first frames", decodingStart);
+    audioManager.start();
+
     return true;
 }
 
 void VideoPlayer::run() {
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        presenting = true;
+    }
+    renderCondition.notify_all();
+
+    // Le thread principal ne fait plus que traiter les événements ; la présentation a son propre thread
+    ThreadCpuScope cpuScope("main");
     while (isRunning) {
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_QUIT:
-                    stop();
-                    return;
-                case SDL_KEYDOWN:
-                    if (event.key.keysym.sym == SDLK_ESCAPE) {
-                        Logger::logInfo("ESC pressed, stopping playback...");
+        if (SDL_WaitEventTimeout(&event, EVENT_WAIT_MS)) {
+            do {
+                switch (event.type) {
+                    case SDL_QUIT:
                         stop();
-                        return;
-                    }
-                    break;
-            }
+                        break;
+                    case SDL_KEYDOWN:
+                        if (event.key.keysym.sym == SDLK_ESCAPE) {
+                            Logger::logInfo("ESC pressed, stopping playback...");
+                            stop();
+                        }
+                        break;
+                }
+            } while (SDL_PollEvent(&event));
         }
 
-        if (!paused) {
-            processFrame();
-        } else {
-            SDL_Delay(10);  // Éviter d'utiliser trop de CPU en pause
+        if (g_stopSignal != 0) {
+            Logger::logInfo("Received signal " + std::to_string(g_stopSignal) + ", stopping playback...");
+            stop();
         }
-
         if (shouldReset.exchange(false)) {
             decoder.seekToStart();
         }
+        if (Tracer::consumeDumpRequest()) {
+            dumpTrace(traceSeconds);
+        }
+        performanceReport.report();
+    }
+
+    joinRenderThread();
+}
+
+void VideoPlayer::joinRenderThread() {
+    // Arrêt demandé par le thread de rendu lui-même (limite de frames) : il se termine seul
+    if (std::this_thread::get_id() == renderThreadId) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(renderJoinMutex);
+    if (renderThread.joinable()) {
+        renderThread.join();
+    }
+    // Le thread de rendu ne touche plus la frame en attente
+    av_frame_free(&pendingFrame);
+}
+
+void VideoPlayer::renderThreadFunction(std::promise<bool> ready, int width, int height) {
+    // Le contexte de rendu SDL appartient au thread qui le crée : tout le rendu reste sur ce thread
+    Tracer::setThreadName("render");
+    ThreadCpuScope cpuScope("render");
+    auto start = StartupTimeline::Clock::now();
+    if (wallConfig.enabled()) {
+        renderer.reset(new VideoWall(rendererBackend, rendererOptions, wallConfig));
+    } else {
+        renderer = Renderer::create(rendererBackend, rendererOptions);
     }
+    bool initialized = renderer->initialize(width, height);
+    startupTimeline.record("renderer init", start);
+    ready.set_value(initialized);
+    if (!initialized) {
+        return;
+    }
+
+    while (waitUntilPresenting()) {
+        processFrame();
+    }
+
+    renderer->cleanup();
+    Logger::logInfo("Render thread terminated");
+}
+
+bool VideoPlayer::waitUntilPresenting() {
+    std::unique_lock<std::mutex> lock(renderMutex);
+    auto canPresent = [this]() { return !isRunning || (presenting && !paused); };
+    if (!canPresent()) {
+        scheduler.reset();  // La pause ne compte pas comme du retard
+        renderCondition.wait(lock, canPresent);
+    }
+    return isRunning;
 }
 
 void VideoPlayer::processFrame() {
-    AVFrame* frame = decoder.getNextFrame();
-    if (frame) {
-        renderer.renderFrame(frame);
+    if (!pendingFrame) {
+        // Dort sur la file ; le délai permet de revoir régulièrement la pause et l'arrêt
+        pendingFrame = decoder.getNextFrame(std::chrono::milliseconds(100));
+        if (!pendingFrame) {
+            return;
+        }
+        if (decoder.consumeDiscontinuity()) {
+            scheduler.reset();
+        }
+        // L'écriture de la texture commence pendant que la frame précédente est affichée
+        if (rendererBackend != RendererBackend::Null) {
+            renderer->prepareFrame(pendingFrame);
+        }
+    }
+
+    static Histogram& renderTime = Metrics::histogram(Metrics::RENDER_TIME_US);
+    static Counter& droppedFrames = Metrics::counter(Metrics::DROPPED_FRAMES);
+
+    // Rendu sans écran : ni cadence ni pertes, la frame est rendue dès qu'elle est décodée
+    if (rendererBackend == RendererBackend::Null) {
+        auto start = std::chrono::steady_clock::now();
+        renderer->renderFrame(pendingFrame);
+        renderTime.recordDuration(std::chrono::steady_clock::now() - start);
+        av_frame_free(&pendingFrame);
+        countRenderedFrame();
+        return;
+    }
+
+    bool hasPts = pendingFrame->pts != AV_NOPTS_VALUE;
+    double pts = hasPts ? pendingFrame->pts * av_q2d(decoder.getVideoStream()->time_base) : 0.0;
+    double delay = hasPts ? scheduler.timeUntilDue(pts) : 0.0;
+
+    // En avance : attente par tranches pour réagir à une pause pendant l'attente
+    if (delay > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(std::min(delay, MAX_SCHEDULE_WAIT)));
+        if (delay > MAX_SCHEDULE_WAIT) {
+            return;
+        }
+        delay = scheduler.timeUntilDue(pts);
+    }
+
+    AVFrame* frame = pendingFrame;
+    pendingFrame = nullptr;
+
+    // Une frame déjà en retard est jetée avant l'envoi au GPU
+    LateFramePolicy::Decision decision = latePolicy.evaluate(-delay);
+    decoder.setDegradationLevel(latePolicy.getDegradationLevel());
+    latePolicy.report(decoder.getDegradedFrameCount());
+    if (decision == LateFramePolicy::Decision::Drop) {
+        scheduler.recordDrop();
+        droppedFrames.add();
+        // La frame a pu être préparée : le rendu ne doit plus la reconnaître à son adresse
+        renderer->abandonPrepared();
         av_frame_free(&frame);
-    } else {
-        SDL_Delay(1);  // Avoid busy waiting
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    renderer->renderFrame(frame);
+    renderTime.recordDuration(std::chrono::steady_clock::now() - start);
+    av_frame_free(&frame);
+    if (hasPts) {
+        scheduler.recordPresent(pts);
+        scheduler.report();
+    }
+    countRenderedFrame();
+}
+
+void VideoPlayer::countRenderedFrame() {
+    static Counter& presentedFrames = Metrics::counter(Metrics::PRESENTED_FRAMES);
+    presentedFrames.add();
+    if (!firstFramePresented) {
+        firstFramePresented = true;
+        startupTimeline.report();
+    }
+
+    renderedFrames++;
+    if (frameLimit > 0 && renderedFrames == frameLimit) {
+        Logger::logInfo("Frame limit of " + std::to_string(frameLimit) + " reached, stopping playback...");
+        stop();
     }
 }
 
 void VideoPlayer::stop() {
-    isRunning = false;
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        isRunning = false;
+    }
+    renderCondition.notify_all();
+    // Le thread de rendu consomme la file de frames et lit le flux : il doit être arrêté
+    // avant que le décodeur vide la file et libère ses contextes
+    joinRenderThread();
     decoder.stopDecoding();
     audioManager.stop();
     wsController.stop();  // Arrêter le WebSocketController
 }
 
 void VideoPlayer::play() {
-    paused = false;
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        paused = false;
+    }
+    renderCondition.notify_all();
+    audioManager.setPaused(false);
 }
 
 void VideoPlayer::pause() {
-    paused = true;
+    {
+        std::lock_guard<std::mutex> lock(renderMutex);
+        paused = true;
+    }
+    // L'audio est l'horloge maître : il s'arrête avec l'image
+    audioManager.setPaused(true);
 }
 
 void VideoPlayer::reset() {
     shouldReset = true;
 }
 
+void VideoPlayer::setTraceOutput(const std::string& path, double seconds) {
+    tracePath = path;
+    traceSeconds = seconds;
+    Tracer::setEnabled(!path.empty());
+    if (!path.empty()) {
+        Logger::logInfo("Tracing enabled, send SIGUSR1 or the trace command to write " + path);
+    }
+}
+
+bool VideoPlayer::dumpTrace(double seconds) {
+    if (!Tracer::isEnabled()) {
+        Logger::logError("Tracing is disabled, start with --trace=<file>");
+        return false;
+    }
+    return Tracer::dump(tracePath, seconds);
+}
+
 void VideoPlayer::setVolume(int vol) {
     volume = std::min(100, std::max(0, vol));
     // Appliquer le volume à l'audio
@@ -2,35 +2,64 @@
 #include "core/AudioManager.h"
 #include "core/VideoDecoder.h"
 #include "core/Renderer.h"
+#include "core/VideoWall.h"
 #include "core/WebSocketController.h"
+#include "core/LateFramePolicy.h"
+#include "core/PresentationScheduler.h"
+#include "core/PerformanceReport.h"
+#include "utils/StartupTimeline.h"
 #include <string>
 #include <thread>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <future>
+#include <memory>
 
 class VideoPlayer {
 public:
     VideoPlayer();
     ~VideoPlayer();
 
+    // À appeler avant initialize()
+    void setDecoderConfig(const DecoderConfig& config) { decoder.setConfig(config); }
+    void setAudioQueueLimits(const QueueLimits& limits) { audioManager.setQueueLimits(limits); }
+    void setAudioDeviceSamples(int samples) { audioManager.setDeviceBufferSamples(samples); }
+    // Null : pas d'écran ni d'audio, frames rendues dès qu'elles sont décodées (mesure du débit)
+    void setRendererBackend(RendererBackend backend) { rendererBackend = backend; }
+    void setRendererOptions(const RendererOptions& options) { rendererOptions = options; }
+    // Arrêt après ce nombre de frames rendues ; 0 : sans limite
+    void setFrameLimit(uint64_t frames) { frameLimit = frames; }
+    // Mur d'images : un décodage, une sortie par tuile
+    void setWallConfig(const WallConfig& config) { wallConfig = config; }
+    // Résumé des métriques toutes les seconds secondes ; 0 : désactivé
+    void setMetricsInterval(double seconds) { performanceReport.setInterval(seconds); }
+    // Active le traçage ; path vide : désactivé. seconds : durée exportée par SIGUSR1
+    void setTraceOutput(const std::string& path, double seconds);
     bool initialize(const std::string& videoPath, uint16_t wsPort = 9002);
     void run();
     void stop();
     void play();
     void pause();
     void reset();
+    void seek(double seconds) { decoder.seekTo(seconds); }
+    void seekToFrame(int64_t frameNumber) { decoder.seekToFrame(frameNumber); }
     void setVolume(int volume);
+    // Écrit la trace des dernières secondes ; sûr depuis n'importe quel thread
+    bool dumpTrace(double seconds);
     bool isPaused() const { return paused; }
 
 private:
     AudioManager audioManager;
     VideoDecoder decoder;
-    Renderer renderer;
+    RendererBackend rendererBackend;
+    RendererOptions rendererOptions;
+    WallConfig wallConfig;
+    std::unique_ptr<Renderer> renderer;
     WebSocketController wsController;
     
-    bool isRunning;
+    std::atomic<bool> isRunning;
     bool isDecodingFinished;
     
     std::thread decodeThread;
@@ -47,15 +76,44 @@ private:
     bool initializeSDL();
     bool openVideoFile(const std::string& videoPath);
     bool initializeAudio();
+    void renderThreadFunction(std::promise<bool> ready, int width, int height);
+    // Bloque tant que la lecture est en pause ou pas encore lancée ; faux à l'arrêt
+    bool waitUntilPresenting();
     void processFrame();
+    // Rapport de démarrage à la première frame, arrêt à la limite de frames
+    void countRenderedFrame();
+    // Attend la fin du thread de rendu, sauf depuis ce thread ; libère ensuite la frame en attente
+    void joinRenderThread();
     void renderFrame(AVFrame* frame);
-    void decodeThreadFunction();
     void cleanup();
     static void audioCallback(void* userdata, Uint8* stream, int len);
     
-    static constexpr size_t MAX_QUEUE_SIZE = 10;
-    
-    bool paused;
+    std::atomic<bool> paused;
     int volume;
     std::atomic<bool> shouldReset;
+
+    StartupTimeline startupTimeline;
+    bool firstFramePresented;
+    uint64_t frameLimit;
+    uint64_t renderedFrames;
+
+    // Frame retirée de la file mais pas encore due ; la précédente reste affichée en attendant
+    AVFrame* pendingFrame;
+    static constexpr double MAX_SCHEDULE_WAIT = 0.05;
+    static constexpr int EVENT_WAIT_MS = 100;
+
+    // Présentation sur un thread dédié : une présentation bloquée par la vsync ne retarde plus les événements
+    std::thread renderThread;
+    std::thread::id renderThreadId;
+    std::mutex renderJoinMutex;  // stop() peut venir de plusieurs threads à la fois
+    std::mutex renderMutex;
+    std::condition_variable renderCondition;
+    bool presenting;  // run() a démarré : le thread de rendu peut présenter
+    PresentationScheduler scheduler;
+    LateFramePolicy latePolicy;
+    PerformanceReport performanceReport;
+
+    std::string tracePath;
+    double traceSeconds;
+    static constexpr double DEFAULT_TRACE_SECONDS = 10.0;
 }; 
\ No newline at end of file
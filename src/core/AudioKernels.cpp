@@ -0,0 +1,155 @@
+#include "AudioKernels.h"
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define AUDIO_KERNELS_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_KERNELS_NEON 1
+#endif
+
+// Arrondi du produit Q15, commun à toutes les variantes
+static constexpr int32_t GAIN_ROUNDING = 1 << 14;
+
+// Position de la trame i ; calculée sans signe, les voies au-delà de la rampe peuvent déborder sans effet
+static inline int32_t rampAt(int32_t position, int32_t step, size_t i) {
+    return static_cast<int32_t>(static_cast<uint32_t>(position) + static_cast<uint32_t>(step) * static_cast<uint32_t>(i));
+}
+
+// --- Référence scalaire, utilisée aussi pour la fin des blocs ---
+
+static void gainRampScalar(const int16_t* src, int16_t* dst, size_t frames, int32_t position, int32_t step) {
+    for (size_t i = 0; i < frames; i++) {
+        int32_t gain = rampAt(position, step, i) >> 16;
+        for (int channel = 0; channel < 2; channel++) {
+            int32_t value = (src[2 * i + channel] * gain + GAIN_ROUNDING) >> 15;
+            dst[2 * i + channel] = static_cast<int16_t>(std::min(32767, std::max(-32768, value)));
+        }
+    }
+}
+
+#if defined(AUDIO_KERNELS_SSE2)
+
+// 4 trames par itération : pmaddwd calcule échantillon * gain + 1 * 2^14 sur 32 bits
+static void gainRampSSE2(const int16_t* src, int16_t* dst, size_t frames, int32_t position, int32_t step) {
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i rounding = _mm_set1_epi32(GAIN_ROUNDING << 16);
+    const __m128i advance = _mm_set1_epi32(rampAt(0, step, 4));
+    __m128i positions = _mm_setr_epi32(position, rampAt(position, step, 1), rampAt(position, step, 2),
+                                       rampAt(position, step, 3));
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        // (gain, 2^14) par trame, dupliqués pour les deux canaux
+        __m128i gains = _mm_or_si128(_mm_srai_epi32(positions, 16), rounding);
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+        __m128i low = _mm_madd_epi16(_mm_unpacklo_epi16(samples, ones), _mm_unpacklo_epi32(gains, gains));
+        __m128i high = _mm_madd_epi16(_mm_unpackhi_epi16(samples, ones), _mm_unpackhi_epi32(gains, gains));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i),
+                         _mm_packs_epi32(_mm_srai_epi32(low, 15), _mm_srai_epi32(high, 15)));
+        positions = _mm_add_epi32(positions, advance);
+    }
+    gainRampScalar(src + 2 * i, dst + 2 * i, frames - i, rampAt(position, step, i), step);
+}
+
+#endif
+
+#if defined(AUDIO_KERNELS_NEON)
+
+static void gainRampNEON(const int16_t* src, int16_t* dst, size_t frames, int32_t position, int32_t step) {
+    const int32x4_t advance = vdupq_n_s32(rampAt(0, step, 4));
+    const int32_t initial[4] = {position, rampAt(position, step, 1), rampAt(position, step, 2), rampAt(position, step, 3)};
+    int32x4_t positions = vld1q_s32(initial);
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        int16x4_t gains = vmovn_s32(vshrq_n_s32(positions, 16));
+        int16x4x2_t perSample = vzip_s16(gains, gains);
+        int16x8_t samples = vld1q_s16(src + 2 * i);
+        int32x4_t low = vrshrq_n_s32(vmull_s16(vget_low_s16(samples), perSample.val[0]), 15);
+        int32x4_t high = vrshrq_n_s32(vmull_s16(vget_high_s16(samples), perSample.val[1]), 15);
+        vst1q_s16(dst + 2 * i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+        positions = vaddq_s32(positions, advance);
+    }
+    gainRampScalar(src + 2 * i, dst + 2 * i, frames - i, rampAt(position, step, i), step);
+}
+
+#endif
+
+AudioKernels::Table AudioKernels::forIsa(Isa isa) {
+    if (!PixelKernels::isSupported(isa)) {
+        isa = Isa::Scalar;
+    }
+    switch (isa) {
+#if defined(AUDIO_KERNELS_SSE2)
+        case Isa::SSE2:
+            return {isa, gainRampSSE2};
+#endif
+#if defined(AUDIO_KERNELS_NEON)
+        case Isa::NEON:
+            return {isa, gainRampNEON};
+#endif
+        default:
+            return {Isa::Scalar, gainRampScalar};
+    }
+}
+
+const AudioKernels::Table& AudioKernels::best() {
+    static const Table table = []() {
+        // Pas de variante AVX2 : un bloc de callback ne fait que quelques Ko
+        for (Isa isa : {Isa::NEON, Isa::SSE2}) {
+            if (PixelKernels::isSupported(isa)) {
+                return forIsa(isa);
+            }
+        }
+        return forIsa(Isa::Scalar);
+    }();
+    return table;
+}
+
+GainStage::GainStage(const AudioKernels::Table& kernels)
+    : kernels(kernels)
+    , position(AudioKernels::UNITY)
+    , target(AudioKernels::UNITY)
+    , step(0)
+    , rampRemaining(0)
+    , rampFrames(1) {
+}
+
+void GainStage::setTarget(float gain) {
+    int32_t newTarget = static_cast<int32_t>(std::min(1.0f, std::max(0.0f, gain)) * 32767.0f + 0.5f) << 16;
+    if (newTarget == target) {
+        return;
+    }
+    // Pas arrondi vers zéro : la rampe ne dépasse jamais la cible, la dernière trame s'y aligne
+    target = newTarget;
+    step = static_cast<int32_t>((static_cast<int64_t>(target) - position) / rampFrames);
+    rampRemaining = rampFrames;
+}
+
+void GainStage::process(const int16_t* src, int16_t* dst, size_t frames) {
+    if (rampRemaining > 0 && frames > 0) {
+        size_t rampPart = std::min(frames, static_cast<size_t>(rampRemaining));
+        kernels.gainRamp(src, dst, rampPart, position, step);
+        position += static_cast<int32_t>(rampPart) * step;
+        rampRemaining -= static_cast<int>(rampPart);
+        if (rampRemaining == 0) {
+            position = target;
+        }
+        src += 2 * rampPart;
+        dst += 2 * rampPart;
+        frames -= rampPart;
+    }
+    if (frames == 0) {
+        return;
+    }
+
+    if (position == AudioKernels::UNITY) {
+        if (src != dst) {
+            memcpy(dst, src, frames * 2 * sizeof(int16_t));
+        }
+    } else {
+        kernels.gainRamp(src, dst, frames, position, 0);
+    }
+}
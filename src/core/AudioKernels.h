@@ -0,0 +1,49 @@
+#pragma once
+#include "PixelKernels.h"
+#include <cstddef>
+#include <cstdint>
+
+// Noyaux de gain audio sur du S16 stéréo entrelacé, vectorisés (NEON, SSE2) avec une version
+// scalaire de référence dont toutes les variantes reproduisent exactement le résultat.
+// Le gain est en virgule fixe : Q15 décalé de 16 bits (0 à 32767 << 16), ce qui permet une
+// rampe linéaire par trame sans dérive ni flottant.
+class AudioKernels {
+public:
+    using Isa = PixelKernels::Isa;
+
+    // Trame i : gain (position + i * step) >> 16, sortie (échantillon * gain + 2^14) >> 15
+    using GainRamp = void (*)(const int16_t* src, int16_t* dst, size_t frames, int32_t position, int32_t step);
+
+    struct Table {
+        Isa isa;
+        GainRamp gainRamp;
+    };
+
+    static constexpr int32_t UNITY = 32767 << 16;
+
+    // Meilleure variante prise en charge, mêmes règles que PixelKernels
+    static const Table& best();
+    static Table forIsa(Isa isa);
+};
+
+// Gain appliqué pendant la copie vers la sortie. Chaque nouvelle cible est rejointe par une
+// rampe linéaire par trame, partant du gain courant, au lieu d'un saut audible.
+// Utilisé uniquement par le thread qui produit la sortie (callback SDL).
+class GainStage {
+public:
+    explicit GainStage(const AudioKernels::Table& kernels = AudioKernels::best());
+
+    void setRampFrames(int frames) { rampFrames = frames > 0 ? frames : 1; }
+    // Gain linéaire, borné à [0, 1] ; sans effet si la cible ne change pas
+    void setTarget(float gain);
+    // Copie frames trames de src vers dst en appliquant le gain ; src et dst peuvent coïncider
+    void process(const int16_t* src, int16_t* dst, size_t frames);
+
+private:
+    AudioKernels::Table kernels;
+    int32_t position;
+    int32_t target;
+    int32_t step;
+    int rampRemaining;
+    int rampFrames;
+};
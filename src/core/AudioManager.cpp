@@ -1,12 +1,53 @@
 #include "AudioManager.h"
 #include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/Tracer.h"
+#include <algorithm>
+#include <cstring>
+#include <pthread.h>
+#include <thread>
 
-AudioManager::AudioManager() : deviceId(0), volume(1.0f), initialized(false) {
+// SDL exige une taille de tampon en puissance de deux
+static int roundUpToPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+AudioManager::AudioManager()
+    : queueLimits(DEFAULT_QUEUE_LIMITS)
+    , clockAnchors(CLOCK_ANCHOR_CAPACITY)
+    , bytesPerSecond(0)
+    , deviceBufferSamples(DEFAULT_DEVICE_BUFFER_SAMPLES)
+    , producerThrottled(false)
+    , currentAnchor{0, 0.0}
+    , nextAnchor{0, 0.0}
+    , hasCurrentAnchor(false)
+    , hasNextAnchor(false)
+    , previousChunkBytes(0)
+    , previousChunkComplete(false)
+    , clockSequence(0)
+    , publishedPts(0.0)
+    , publishedTime(0)
+    , publishedSpan(0.0)
+    , underruns(0)
+    , callbackTrace(nullptr)
+    , callbackClock(0)
+    , callbackClockPublished(false)
+    , callbackThreadId(0)
+    , underrunMetric(Metrics::counter(Metrics::AUDIO_UNDERRUNS))
+    , latencyMetric(Metrics::gauge(Metrics::AUDIO_LATENCY_MS))
+    , bufferMetric(Metrics::gauge(Metrics::AUDIO_BUFFER_MS))
+    , deviceId(0)
+    , volume(1.0f)
+    , initialized(false)
+    , stopping(false) {
     state.swr_ctx = nullptr;
     state.stream = nullptr;
     state.codec_ctx = nullptr;
     state.stream_index = -1;
-    state.clock = 0.0;
 }
 
 AudioManager::~AudioManager() {
@@ -23,11 +64,16 @@ bool AudioManager::initialize(AVCodecContext* codecContext, AVStream* stream) {
     SDL_AudioSpec wanted_spec, spec;
     wanted_spec.freq = codecContext->sample_rate;
     wanted_spec.format = AUDIO_S16SYS;
-    wanted_spec.channels = codecContext->ch_layout.nb_channels;
+    // Le rééchantillonneur sort toujours du stéréo
+    wanted_spec.channels = OUTPUT_CHANNELS;
     wanted_spec.silence = 0;
-    wanted_spec.samples = 1024;
+    wanted_spec.samples = static_cast<Uint16>(std::min(roundUpToPowerOfTwo(std::max(deviceBufferSamples, 64)), 32768));
     wanted_spec.callback = audioCallback;
     wanted_spec.userdata = this;
+    // Le callback ne peut ni verrouiller ni allouer : son anneau de trace est créé ici
+    if (!callbackTrace) {
+        callbackTrace = Tracer::createThreadTrace("audio callback");
+    }
 
     deviceId = SDL_OpenAudioDevice(nullptr, 0, &wanted_spec, &spec, 0);
     if (deviceId == 0) {
@@ -36,7 +82,9 @@ bool AudioManager::initialize(AVCodecContext* codecContext, AVStream* stream) {
     }
 
     Logger::logInfo("Audio device opened with freq: " + std::to_string(spec.freq) + 
-                   " Hz, channels: " + std::to_string(spec.channels));
+                   " Hz, channels: " + std::to_string(spec.channels) +
+                   ", buffer: " + std::to_string(spec.samples) + " samples (" +
+                   std::to_string(spec.samples * 1000 / std::max(spec.freq, 1)) + " ms)");
 
     // Initialize resampler
     state.swr_ctx = swr_alloc();
@@ -69,87 +117,237 @@ bool AudioManager::initialize(AVCodecContext* codecContext, AVStream* stream) {
         return false;
     }
 
-    Logger::logInfo("Audio resampler initialized");
+    // Tampon PCM dimensionné sur le budget de la file audio, au format de sortie
+    bytesPerSecond = spec.freq * OUTPUT_FRAME_BYTES;
+    gain.setRampFrames(spec.freq * GAIN_RAMP_MS / 1000);
+    // Le producteur passe sous le seuil haut puis écrit une frame entière : le tampon garde
+    // la place d'une frame au-dessus du seuil, sinon l'écriture attendrait le callback
+    int frameSamples = codecContext->frame_size > 0 ? codecContext->frame_size : MAX_VARIABLE_FRAME_SAMPLES;
+    size_t frameBytes = static_cast<size_t>(std::max(swr_get_out_samples(state.swr_ctx, frameSamples), 0)) *
+                        OUTPUT_FRAME_BYTES;
+    pcmBuffer.reset(new PcmRingBuffer(highWatermarkBytes() + frameBytes));
+    stopping = false;
+
+    Logger::logInfo("Audio resampler initialized, PCM buffer " + std::to_string(pcmBuffer->capacity() / 1024) + " KB");
     initialized = true;
+    return true;
+}
+
+void AudioManager::start() {
+    if (!initialized) {
+        return;
+    }
     SDL_PauseAudioDevice(deviceId, 0);
     Logger::logInfo("Audio playback started");
-    return true;
 }
 
-void AudioManager::pushFrame(AVFrame* frame) {
-    if (!initialized) return;
+void AudioManager::setPaused(bool paused) {
+    if (!initialized) {
+        return;
+    }
+    SDL_PauseAudioDevice(deviceId, paused ? 1 : 0);
+}
 
-    std::unique_lock<std::mutex> lock(state.audioMutex);
-    state.audioQueue.push(frame);
-    lock.unlock();
-    state.audioCondition.notify_one();
+size_t AudioManager::highWatermarkBytes() const {
+    size_t durationBytes = static_cast<size_t>(queueLimits.maxSeconds * bytesPerSecond);
+    size_t bytes = std::min(queueLimits.maxBytes, durationBytes);
+    return std::max<size_t>(bytes - bytes % OUTPUT_FRAME_BYTES, OUTPUT_FRAME_BYTES);
 }
 
-void AudioManager::audioCallback(void* userdata, Uint8* stream, int len) {
-    AudioManager* audio = static_cast<AudioManager*>(userdata);
-    std::unique_lock<std::mutex> lock(audio->state.audioMutex);
+double AudioManager::getQueuedSeconds() const {
+    return bytesPerSecond > 0 ? static_cast<double>(getQueuedBytes()) / bytesPerSecond : 0.0;
+}
+
+bool AudioManager::waitForQueueRoom(std::chrono::milliseconds timeout) {
+    if (!initialized) {
+        return true;
+    }
 
-    memset(stream, 0, len);
+    // Même hystérésis que QueueBudget : arrêt au seuil haut, reprise sous le seuil bas.
+    // Le remplissage physique compte : après un flush en pause, les octets abandonnés
+    // occupent encore le tampon et writePcm() ne pourrait pas écrire
+    size_t highWatermark = highWatermarkBytes();
+    size_t lowWatermark = static_cast<size_t>(highWatermark * queueLimits.lowWatermark);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        size_t queued = pcmBuffer->filled();
+        if (!producerThrottled && queued < highWatermark) {
+            return true;
+        }
+        producerThrottled = true;
+        if (queued <= lowWatermark) {
+            producerThrottled = false;
+            return true;
+        }
 
-    if (audio->state.audioQueue.empty()) {
-        return;
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline || !initialized || stopping) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(PRODUCER_POLL, deadline - now));
     }
+}
 
-    AVFrame* frame = audio->state.audioQueue.front();
-    if (!frame) {
-        audio->state.audioQueue.pop();
+void AudioManager::pushFrame(AVFrame* frame) {
+    if (!initialized) {
+        av_frame_free(&frame);
         return;
     }
+    if (callbackThreadId == 0 && callbackClockPublished.load(std::memory_order_acquire)) {
+        callbackThreadId = Metrics::registerThreadClock("audio callback",
+                                                        callbackClock.load(std::memory_order_relaxed));
+    }
 
-    // Calculer le nombre d'échantillons à convertir
-    int out_samples = frame->nb_samples;
+    TraceScope span("resample audio", frame->pts);
+    // Le tampon de sortie ne grandit qu'avec la taille des frames : pas d'allocation en régime établi
+    int maxSamples = swr_get_out_samples(state.swr_ctx, frame->nb_samples);
+    if (maxSamples > 0) {
+        size_t needed = static_cast<size_t>(maxSamples) * OUTPUT_FRAME_BYTES;
+        if (resampleBuffer.size() < needed) {
+            resampleBuffer.resize(needed);
+        }
 
-    // Allouer le buffer temporaire avec alignement
-    uint8_t* buffer = nullptr;
-    int buffer_size = av_samples_get_buffer_size(
-        nullptr,
-        2,  // Toujours en stéréo
-        out_samples,
-        AV_SAMPLE_FMT_S16,
-        1  // Alignement sur 1 byte pour plus de sécurité
-    );
+        // Les premiers échantillons produits sont ceux retenus par le rééchantillonneur lors des frames précédentes
+        int outputRate = bytesPerSecond / OUTPUT_FRAME_BYTES;
+        double resamplerDelay = static_cast<double>(swr_get_delay(state.swr_ctx, outputRate)) / outputRate;
 
-    if (buffer_size > 0) {
-        buffer = reinterpret_cast<uint8_t*>(av_malloc(buffer_size));
-        if (buffer) {
-            // Convertir l'audio
-            int samples_converted = swr_convert(
-                audio->state.swr_ctx,
-                &buffer,
-                out_samples,
-                (const uint8_t**)frame->data,
-                frame->nb_samples
-            );
-
-            if (samples_converted > 0) {
-                int actual_buffer_size = samples_converted * 2 * sizeof(int16_t);
-                if (actual_buffer_size <= len) {
-                    SDL_MixAudioFormat(
-                        stream,
-                        buffer,
-                        AUDIO_S16SYS,
-                        actual_buffer_size,
-                        static_cast<int>(SDL_MIX_MAXVOLUME * audio->volume)
-                    );
-
-                    if (frame->pts != AV_NOPTS_VALUE) {
-                        audio->state.clock = frame->pts * av_q2d(audio->state.stream->time_base);
-                    }
-                }
+        uint8_t* output = resampleBuffer.data();
+        int samples = swr_convert(state.swr_ctx, &output, maxSamples,
+                                  const_cast<const uint8_t**>(frame->extended_data), frame->nb_samples);
+        if (samples > 0) {
+            if (frame->pts != AV_NOPTS_VALUE) {
+                // File pleine : l'ancre est sautée, la suivante corrigera l'horloge
+                clockAnchors.tryPush(ClockAnchor{pcmBuffer->getWritePosition(),
+                                                 frame->pts * av_q2d(state.stream->time_base) - resamplerDelay});
             }
-            av_freep(&buffer);
+            writePcm(output, static_cast<size_t>(samples) * OUTPUT_FRAME_BYTES);
+            bufferMetric.set(getQueuedSeconds() * 1000.0);
         }
     }
-
-    audio->state.audioQueue.pop();
     av_frame_free(&frame);
 }
 
+void AudioManager::writePcm(const uint8_t* data, size_t bytes) {
+    while (bytes > 0 && initialized && !stopping) {
+        size_t written = pcmBuffer->write(data, bytes);
+        data += written;
+        bytes -= written;
+        if (bytes > 0) {
+            std::this_thread::sleep_for(PRODUCER_POLL);
+        }
+    }
+}
+
+void AudioManager::flush() {
+    if (!initialized) {
+        return;
+    }
+    pcmBuffer->flush();
+    // Les échantillons retenus par le rééchantillonneur précèdent eux aussi le seek
+    swr_init(state.swr_ctx);
+}
+
+bool AudioManager::ptsAt(size_t chunkStart, double& pts) {
+    // Dernière ancre écrite avant le début du bloc (positions croissantes, comparées sans débordement)
+    while (true) {
+        if (!hasNextAnchor) {
+            hasNextAnchor = clockAnchors.tryPop(nextAnchor);
+        }
+        if (!hasNextAnchor || static_cast<ptrdiff_t>(nextAnchor.position - chunkStart) > 0) {
+            break;
+        }
+        currentAnchor = nextAnchor;
+        hasCurrentAnchor = true;
+        hasNextAnchor = false;
+    }
+
+    if (!hasCurrentAnchor) {
+        return false;
+    }
+    pts = currentAnchor.pts + static_cast<double>(chunkStart - currentAnchor.position) / bytesPerSecond;
+    return true;
+}
+
+void AudioManager::updateClock(Clock::time_point now, size_t chunkStart, size_t copied, size_t requested) {
+    // Pendant le callback, le périphérique joue encore le bloc précédent : l'échantillon audible
+    // le précède d'autant, et seuls les échantillons livrés sans trou peuvent être interpolés
+    double chunkPts;
+    if (ptsAt(chunkStart, chunkPts)) {
+        double deviceQueued = static_cast<double>(previousChunkBytes) / bytesPerSecond;
+        double span = deviceQueued;
+        if (previousChunkComplete) {
+            span += static_cast<double>(copied) / bytesPerSecond;
+        }
+
+        clockSequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        publishedPts.store(chunkPts - deviceQueued, std::memory_order_relaxed);
+        publishedTime.store(std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count(),
+                            std::memory_order_relaxed);
+        publishedSpan.store(span, std::memory_order_relaxed);
+        clockSequence.fetch_add(1, std::memory_order_release);
+    }
+
+    previousChunkBytes = copied;
+    previousChunkComplete = copied == requested;
+}
+
+AudioManager::ClockReading AudioManager::readClock(Clock::time_point now) const {
+    double pts;
+    int64_t time;
+    double span;
+    uint32_t sequence;
+    do {
+        sequence = clockSequence.load(std::memory_order_acquire);
+        pts = publishedPts.load(std::memory_order_relaxed);
+        time = publishedTime.load(std::memory_order_relaxed);
+        span = publishedSpan.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || sequence != clockSequence.load(std::memory_order_relaxed));
+
+    if (sequence == 0) {
+        return {0.0, false};
+    }
+
+    // Sans nouveau callback au-delà des échantillons livrés, le périphérique est arrêté : l'horloge s'y fige
+    double elapsed = std::chrono::duration<double>(now.time_since_epoch() - std::chrono::nanoseconds(time)).count();
+    elapsed = std::max(0.0, elapsed);
+    return {pts + std::min(elapsed, span), elapsed < span};
+}
+
+void AudioManager::audioCallback(void* userdata, Uint8* stream, int len) {
+    // Thread audio temps réel : ni verrou, ni allocation, ni rééchantillonnage
+    AudioManager* audio = static_cast<AudioManager*>(userdata);
+    // Anneau de trace créé par initialize() : le callback ne fait que l'adopter
+    Tracer::adoptThreadTrace(audio->callbackTrace);
+    TraceScope span(audio->callbackTrace ? "audio callback" : nullptr);
+    Clock::time_point now = Clock::now();
+    size_t requested = static_cast<size_t>(len);
+    // Volume appliqué dans la même passe que la copie depuis le tampon PCM
+    audio->gain.setTarget(audio->volume.load(std::memory_order_relaxed));
+    size_t copied = audio->pcmBuffer->read(stream, requested, [audio](uint8_t* dst, const uint8_t* src, size_t bytes) {
+        audio->gain.process(reinterpret_cast<const int16_t*>(src), reinterpret_cast<int16_t*>(dst),
+                            bytes / OUTPUT_FRAME_BYTES);
+    });
+    // Le thread audio appartient à SDL : son horloge CPU est publiée au premier callback,
+    // et enregistrée par le thread de décodage audio (l'enregistrement verrouille et alloue)
+    if (!audio->callbackClockPublished.load(std::memory_order_relaxed)) {
+        clockid_t clock;
+        if (pthread_getcpuclockid(pthread_self(), &clock) == 0) {
+            audio->callbackClock.store(clock, std::memory_order_relaxed);
+            audio->callbackClockPublished.store(true, std::memory_order_release);
+        }
+    }
+    if (copied < requested) {
+        memset(stream + copied, 0, requested - copied);
+        audio->underruns.fetch_add(1, std::memory_order_relaxed);
+        audio->underrunMetric.add();
+    }
+    // Du décodage à la sortie : PCM en attente plus le bloc remis au périphérique
+    audio->latencyMetric.set((audio->pcmBuffer->available() + requested) * 1000.0 / audio->bytesPerSecond);
+    audio->updateClock(now, audio->pcmBuffer->getReadPosition() - copied, copied, requested);
+}
+
 void AudioManager::cleanup() {
     if (deviceId) {
         SDL_PauseAudioDevice(deviceId, 1);
@@ -162,20 +360,18 @@ void AudioManager::cleanup() {
         state.swr_ctx = nullptr;
     }
 
-    std::unique_lock<std::mutex> lock(state.audioMutex);
-    while (!state.audioQueue.empty()) {
-        AVFrame* frame = state.audioQueue.front();
-        state.audioQueue.pop();
-        av_frame_free(&frame);
-    }
+    // Le callback est arrêté avec le périphérique : le tampon peut être libéré
+    pcmBuffer.reset();
+    Metrics::unregisterThread(callbackThreadId);
+    callbackThreadId = 0;
+    callbackClockPublished = false;
 }
 
-void AudioManager::stop() {
-    cleanup();
-    initialized = false;
+void AudioManager::interrupt() {
+    stopping = true;
 }
 
-// Ajouter cette méthode pour obtenir l'horloge audio
-double AudioManager::getAudioClock() const {
-    return state.clock;
+void AudioManager::stop() {
+    initialized = false;
+    cleanup();
 }
\ No newline at end of file
@@ -1,8 +1,16 @@
 #pragma once
 #include <SDL2/SDL.h>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <vector>
+#include "AudioKernels.h"
+#include "../utils/QueueBudget.h"
+#include "../utils/PcmRingBuffer.h"
+#include "../utils/SPSCRingBuffer.h"
+#include "../utils/Metrics.h"
+#include "../utils/Tracer.h"
 
 extern "C" {
     #include <libavcodec/avcodec.h>
@@ -12,35 +20,133 @@ extern "C" {
     #include <libavutil/channel_layout.h>
 }
 
+// Sortie audio : le thread de décodage audio rééchantillonne chaque frame en S16 stéréo
+// dans un tampon PCM sans verrou ; le callback SDL ne fait que copier exactement les octets
+// demandés, sans allocation ni verrou, et compte les sous-alimentations.
+// L'horloge audio donne le PTS de l'échantillon audible : position lue depuis une ancre PTS,
+// moins ce que le périphérique n'a pas encore joué, interpolée entre deux callbacks.
+// Le volume est appliqué pendant la copie, avec une rampe par échantillon à chaque changement.
 class AudioManager {
 public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr QueueLimits DEFAULT_QUEUE_LIMITS{16 * 1024 * 1024, 2.0};
+    // Taille du tampon du périphérique en échantillons : latence contre risque de sous-alimentation
+    static constexpr int DEFAULT_DEVICE_BUFFER_SAMPLES = 1024;
+
+    struct ClockReading {
+        double pts;
+        // Faux si le périphérique ne joue plus d'échantillons (pause, sous-alimentation, arrêt)
+        bool running;
+    };
+
     AudioManager();
     ~AudioManager();
 
     bool initialize(AVCodecContext* codecContext, AVStream* stream);
+    // Démarre la lecture ; les frames poussées avant sont conservées
+    void start();
+    // Suspend la lecture sans vider la file
+    void setPaused(bool paused);
     void cleanup();
+    // Débloque le producteur, qui abandonne ses écritures : à appeler avant de joindre les
+    // threads de décodage, le callback ne vidant plus le tampon en pause
+    void interrupt();
     void stop();
-    
+
     static void audioCallback(void* userdata, Uint8* stream, int len);
+    // À appeler avant initialize()
+    void setQueueLimits(const QueueLimits& limits) { queueLimits = limits; }
+    // À appeler avant initialize() ; arrondi à une puissance de deux
+    void setDeviceBufferSamples(int samples) { deviceBufferSamples = samples; }
+    // Producteur : attend que le tampon PCM soit repassé sous le seuil bas
+    bool waitForQueueRoom(std::chrono::milliseconds timeout);
+    // Producteur : rééchantillonne la frame dans le tampon PCM puis la libère
     void pushFrame(AVFrame* frame);
-    double getAudioClock() const;
+    // Producteur : abandonne l'audio en attente (seek)
+    void flush();
+    // Lisible depuis n'importe quel thread ; l'interpolation s'arrête au bout des échantillons livrés
+    ClockReading readClock(Clock::time_point now) const;
+    double getAudioClock() const { return readClock(Clock::now()).pts; }
+    size_t getQueuedBytes() const { return pcmBuffer ? pcmBuffer->available() : 0; }
+    double getQueuedSeconds() const;
+    // Callbacks qui n'ont pas trouvé assez d'échantillons, complétés par du silence
+    uint64_t getUnderrunCount() const { return underruns.load(std::memory_order_relaxed); }
 
     bool isInitialized() const { return initialized; }
     void setVolume(float vol) { volume = vol; }
 
 private:
+    // PTS de l'octet écrit à position dans le tampon PCM
+    struct ClockAnchor {
+        size_t position;
+        double pts;
+    };
+
     struct AudioState {
         SwrContext *swr_ctx;
         AVStream *stream;
         AVCodecContext *codec_ctx;
-        std::queue<AVFrame*> audioQueue;
-        std::mutex audioMutex;
-        std::condition_variable audioCondition;
         int stream_index;
-        double clock;
     } state;
 
+    // Écrit tous les octets, en attendant que le callback libère de la place si besoin
+    void writePcm(const uint8_t* data, size_t bytes);
+    // Consommateur : PTS du début du bloc lu, faux tant qu'aucune ancre ne le précède
+    bool ptsAt(size_t chunkStart, double& pts);
+    // Consommateur : publie l'horloge du callback courant
+    void updateClock(Clock::time_point now, size_t chunkStart, size_t copied, size_t requested);
+    size_t highWatermarkBytes() const;
+
+    QueueLimits queueLimits;
+    std::unique_ptr<PcmRingBuffer> pcmBuffer;
+    SPSCRingBuffer<ClockAnchor> clockAnchors;
+    int bytesPerSecond;
+    int deviceBufferSamples;
+
+    // Propres au producteur
+    std::vector<uint8_t> resampleBuffer;
+    bool producerThrottled;
+
+    // Propres au callback
+    ClockAnchor currentAnchor;
+    ClockAnchor nextAnchor;
+    bool hasCurrentAnchor;
+    bool hasNextAnchor;
+    GainStage gain;
+    // Bloc précédent, encore dans le tampon du périphérique pendant le callback courant
+    size_t previousChunkBytes;
+    bool previousChunkComplete;
+
+    // Publication seqlock : pts audible à publishedTime, avec publishedSpan secondes
+    // d'échantillons contigus derrière ; séquence impaire pendant l'écriture
+    alignas(64) std::atomic<uint32_t> clockSequence;
+    std::atomic<double> publishedPts;
+    std::atomic<int64_t> publishedTime;
+    std::atomic<double> publishedSpan;
+    std::atomic<uint64_t> underruns;
+    ThreadTrace* callbackTrace;  // nullptr : traçage désactivé à l'initialisation
+    // Horloge CPU du thread du callback, publiée par le callback, enregistrée par le producteur
+    std::atomic<clockid_t> callbackClock;
+    std::atomic<bool> callbackClockPublished;
+    uint64_t callbackThreadId;  // 0 : pas encore enregistré
+    // Résolues à la construction : la recherche dans le registre verrouille
+    Counter& underrunMetric;
+    Gauge& latencyMetric;
+    Gauge& bufferMetric;  // PCM en attente, mis à jour par le producteur
     SDL_AudioDeviceID deviceId;
-    float volume;
-    bool initialized;
-}; 
\ No newline at end of file
+    std::atomic<float> volume;
+    std::atomic<bool> initialized;
+    std::atomic<bool> stopping;
+
+    // S16 stéréo
+    static constexpr int OUTPUT_CHANNELS = 2;
+    static constexpr int OUTPUT_FRAME_BYTES = OUTPUT_CHANNELS * 2;
+    static constexpr size_t CLOCK_ANCHOR_CAPACITY = 1024;
+    // Taille de frame supposée quand le codec ne l'annonce pas (PCM, Vorbis...)
+    static constexpr int MAX_VARIABLE_FRAME_SAMPLES = 8192;
+    // Durée des rampes de volume : assez longue pour éviter les clics, assez courte pour rester réactive
+    static constexpr int GAIN_RAMP_MS = 10;
+    // Le callback ne réveille jamais le producteur (ce serait un verrou) : celui-ci sonde le tampon
+    static constexpr std::chrono::milliseconds PRODUCER_POLL{5};
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "../utils/QueueBudget.h"
+
+enum class DecoderThreading {
+    Auto,   // frame + slice selon le nombre de cœurs
+    Frame,
+    Slice,
+    Off
+};
+
+enum class LoopMode {
+    Seek,     // seek au début à la fin du fichier
+    Gapless,  // début de boucle pré-décodé, PTS continus d'une boucle à l'autre
+    Cache     // premier passage conservé en mémoire, boucles suivantes rejouées sans décodage
+};
+
+struct DecoderConfig {
+    // Sondage du fichier à l'ouverture ; 0 : valeurs par défaut de FFmpeg (5 Mo, 5 s)
+    int64_t probeSize = 0;
+    int64_t analyzeDurationUs = 0;
+
+    DecoderThreading threading = DecoderThreading::Auto;
+    int threadCount = 0;  // 0 : un thread par cœur
+    // Budget de la file de frames décodées, en mémoire et en durée de présentation
+    QueueLimits videoQueue{256 * 1024 * 1024, 2.0};
+
+    LoopMode loopMode = LoopMode::Seek;
+    // Durée maximale pré-décodée pour le mode Gapless (la mémoire est limitée à la moitié de videoQueue)
+    double loopPrerollSeconds = 2.0;
+    // Budget du cache de boucle ; au-delà de l'estimation brute, les frames sont recompressées sans perte
+    size_t loopCacheBytes = 512 * 1024 * 1024;
+
+    // Réduction des frames décodées avant la file, ratio conservé ; 0x0 : résolution source.
+    // downscaleToDisplay : la taille est celle de l'écran, renseignée une fois SDL initialisé
+    int downscaleWidth = 0;
+    int downscaleHeight = 0;
+    bool downscaleToDisplay = false;
+};
@@ -0,0 +1,214 @@
+#include "FrameConverter.h"
+#include "PixelKernels.h"
+#include "../utils/Logger.h"
+#include <cstring>
+
+FrameConverter::FrameConverter()
+    : swsContext(nullptr)
+    , convertedFrame(nullptr)
+    , loggedConversionFormat(AV_PIX_FMT_NONE) {
+}
+
+FrameConverter::~FrameConverter() {
+    release();
+}
+
+void FrameConverter::release() {
+    if (swsContext) {
+        sws_freeContext(swsContext);
+        swsContext = nullptr;
+    }
+
+    av_frame_free(&convertedFrame);
+    chromaRows.clear();
+    chromaRows.shrink_to_fit();
+    loggedConversionFormat = AV_PIX_FMT_NONE;
+}
+
+bool FrameConverter::ensureConvertedFrame(AVPixelFormat format, int width, int height) {
+    if (!convertedFrame) {
+        convertedFrame = av_frame_alloc();
+        if (!convertedFrame) {
+            return false;
+        }
+    }
+    if (convertedFrame->buf[0] && convertedFrame->format == format &&
+        convertedFrame->width == width && convertedFrame->height == height) {
+        return true;
+    }
+
+    av_frame_unref(convertedFrame);
+    convertedFrame->format = format;
+    convertedFrame->width = width;
+    convertedFrame->height = height;
+    if (av_frame_get_buffer(convertedFrame, 0) < 0) {
+        Logger::logError("Failed to allocate conversion buffer");
+        av_frame_unref(convertedFrame);
+        return false;
+    }
+    return true;
+}
+
+void FrameConverter::logConversion(const AVFrame* frame, AVPixelFormat layout, const char* method) {
+    if (loggedConversionFormat == frame->format) {
+        return;
+    }
+    const char* name = av_get_pix_fmt_name(static_cast<AVPixelFormat>(frame->format));
+    Logger::logInfo("Pixel format " + std::string(name ? name : "unknown") + " is converted to " +
+                    av_get_pix_fmt_name(layout) + " before upload (" + method + ")");
+    loggedConversionFormat = frame->format;
+}
+
+bool FrameConverter::isFullRange(const AVFrame* frame) {
+    return frame->format == AV_PIX_FMT_YUVJ420P || frame->color_range == AVCOL_RANGE_JPEG;
+}
+
+size_t FrameConverter::copyPlanes(const AVFrame* frame, std::vector<uint8_t>& destination) {
+    int planes = frame->format == AV_PIX_FMT_NV12 ? 2 : 3;
+    size_t offset = 0;
+    for (int plane = 0; plane < planes; plane++) {
+        int rows = plane == 0 ? frame->height : (frame->height + 1) / 2;
+        int chromaWidth = (frame->width + 1) / 2;
+        int rowBytes = plane == 0 ? frame->width : planes == 2 ? 2 * chromaWidth : chromaWidth;
+        size_t needed = offset + static_cast<size_t>(rows) * rowBytes;
+        if (destination.size() < needed) {
+            destination.resize(needed);
+        }
+        for (int row = 0; row < rows; row++) {
+            memcpy(destination.data() + offset,
+                   frame->data[plane] + static_cast<ptrdiff_t>(row) * frame->linesize[plane], rowBytes);
+            offset += rowBytes;
+        }
+    }
+    return offset;
+}
+
+bool FrameConverter::isUploadable(const AVFrame* frame, AVPixelFormat layout) {
+    // Les textures YUV de SDL attendent la plage limitée : une source en plage complète est convertie
+    if (isFullRange(frame)) {
+        return false;
+    }
+    if (frame->format == AV_PIX_FMT_YUV420P) {
+        return layout == AV_PIX_FMT_YUV420P;
+    }
+    return frame->format == AV_PIX_FMT_NV12 && layout == AV_PIX_FMT_NV12;
+}
+
+const AVFrame* FrameConverter::convert(const AVFrame* frame, AVPixelFormat layout) {
+    if (isUploadable(frame, layout)) {
+        return frame;
+    }
+    if (!ensureConvertedFrame(layout, frame->width, frame->height)) {
+        return nullptr;
+    }
+    return convertPlanes(frame, layout, convertedFrame->data, convertedFrame->linesize) ? convertedFrame : nullptr;
+}
+
+bool FrameConverter::convertInto(const AVFrame* frame, AVPixelFormat layout, uint8_t* const data[], const int linesize[]) {
+    if (!isUploadable(frame, layout)) {
+        return convertPlanes(frame, layout, data, linesize);
+    }
+
+    int planes = layout == AV_PIX_FMT_NV12 ? 2 : 3;
+    for (int plane = 0; plane < planes; plane++) {
+        int rows = plane == 0 ? frame->height : (frame->height + 1) / 2;
+        int chromaWidth = (frame->width + 1) / 2;
+        int rowBytes = plane == 0 ? frame->width : planes == 2 ? 2 * chromaWidth : chromaWidth;
+        for (int row = 0; row < rows; row++) {
+            memcpy(data[plane] + static_cast<ptrdiff_t>(row) * linesize[plane],
+                   frame->data[plane] + static_cast<ptrdiff_t>(row) * frame->linesize[plane], rowBytes);
+        }
+    }
+    return true;
+}
+
+bool FrameConverter::convertPlanes(const AVFrame* frame, AVPixelFormat layout, uint8_t* const data[], const int linesize[]) {
+    switch (frame->format) {
+        case AV_PIX_FMT_YUV420P:
+        case AV_PIX_FMT_YUVJ420P:
+        case AV_PIX_FMT_NV12:
+        case AV_PIX_FMT_YUV420P10LE:
+            convertWithKernels(frame, layout, isFullRange(frame), data, linesize);
+            return true;
+        default:
+            return convertWithSwscale(frame, layout, data, linesize);
+    }
+}
+
+void FrameConverter::convertWithKernels(const AVFrame* frame, AVPixelFormat layout, bool fullRange,
+                                        uint8_t* const data[], const int linesize[]) {
+    const PixelKernels::Table& kernels = PixelKernels::best();
+    logConversion(frame, layout, PixelKernels::isaName(kernels.isa));
+
+    bool tenBit = frame->format == AV_PIX_FMT_YUV420P10LE;
+    // Ligne 8 bits en plage limitée : décalée depuis 10 bits si besoin, puis compressée si en plage complète
+    auto convertRow = [&](const uint8_t* src, uint8_t* dst, int count, bool chroma) {
+        if (tenBit) {
+            kernels.downshift10(reinterpret_cast<const uint16_t*>(src), dst, count);
+        } else if (!fullRange) {
+            memcpy(dst, src, count);
+        }
+        if (fullRange) {
+            kernels.fullToLimited(tenBit ? dst : src, dst, count, chroma);
+        }
+    };
+
+    for (int y = 0; y < frame->height; y++) {
+        convertRow(frame->data[0] + static_cast<ptrdiff_t>(y) * frame->linesize[0],
+                   data[0] + static_cast<ptrdiff_t>(y) * linesize[0], frame->width, false);
+    }
+
+    int chromaWidth = (frame->width + 1) / 2;
+    int chromaHeight = (frame->height + 1) / 2;
+    bool sourceInterleaved = frame->format == AV_PIX_FMT_NV12;
+    bool outputInterleaved = layout == AV_PIX_FMT_NV12;
+    if (!sourceInterleaved && outputInterleaved) {
+        chromaRows.resize(2 * static_cast<size_t>(chromaWidth));
+    }
+
+    for (int y = 0; y < chromaHeight; y++) {
+        const uint8_t* source = frame->data[1] + static_cast<ptrdiff_t>(y) * frame->linesize[1];
+        uint8_t* first = data[1] + static_cast<ptrdiff_t>(y) * linesize[1];
+        if (sourceInterleaved && outputInterleaved) {
+            convertRow(source, first, 2 * chromaWidth, true);
+        } else if (sourceInterleaved) {
+            uint8_t* second = data[2] + static_cast<ptrdiff_t>(y) * linesize[2];
+            kernels.deinterleave(source, first, second, chromaWidth);
+            if (fullRange) {
+                kernels.fullToLimited(first, first, chromaWidth, true);
+                kernels.fullToLimited(second, second, chromaWidth, true);
+            }
+        } else {
+            const uint8_t* sourceV = frame->data[2] + static_cast<ptrdiff_t>(y) * frame->linesize[2];
+            if (outputInterleaved) {
+                uint8_t* rowU = chromaRows.data();
+                uint8_t* rowV = rowU + chromaWidth;
+                convertRow(source, rowU, chromaWidth, true);
+                convertRow(sourceV, rowV, chromaWidth, true);
+                kernels.interleave(rowU, rowV, first, chromaWidth);
+            } else {
+                convertRow(source, first, chromaWidth, true);
+                convertRow(sourceV, data[2] + static_cast<ptrdiff_t>(y) * linesize[2], chromaWidth, true);
+            }
+        }
+    }
+}
+
+bool FrameConverter::convertWithSwscale(const AVFrame* frame, AVPixelFormat layout,
+                                        uint8_t* const data[], const int linesize[]) {
+    logConversion(frame, layout, "swscale");
+    swsContext = sws_getCachedContext(swsContext,
+        frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+        frame->width, frame->height, layout,
+        SWS_BILINEAR, nullptr, nullptr, nullptr
+    );
+    if (!swsContext) {
+        Logger::logError("Failed to initialize scaler");
+        return false;
+    }
+
+    sws_scale(swsContext,
+              frame->data, frame->linesize, 0, frame->height,
+              data, linesize);
+    return true;
+}
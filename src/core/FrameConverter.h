@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+    #include <libavutil/frame.h>
+    #include <libavutil/pixfmt.h>
+    #include <libavutil/pixdesc.h>
+    #include <libswscale/swscale.h>
+}
+
+// Prépare une frame décodée pour une texture YUV 8 bits en plage limitée, au format
+// yuv420p (IYUV) ou nv12. Partagé par les backends de rendu ; utilisé par un seul thread.
+class FrameConverter {
+public:
+    FrameConverter();
+    ~FrameConverter();
+
+    // Frame envoyable telle quelle, ou convertie vers layout ; nullptr en cas d'échec.
+    // La frame convertie reste valide jusqu'à l'appel suivant
+    const AVFrame* convert(const AVFrame* frame, AVPixelFormat layout);
+    // Écrit la frame au format layout dans des plans fournis (mémoire d'une texture verrouillée)
+    bool convertInto(const AVFrame* frame, AVPixelFormat layout, uint8_t* const data[], const int linesize[]);
+    void release();
+
+    static bool isFullRange(const AVFrame* frame);
+    // Vrai si les plans de la frame peuvent être envoyés sans conversion vers une texture layout
+    static bool isUploadable(const AVFrame* frame, AVPixelFormat layout);
+    // Copie ligne à ligne des plans d'une frame yuv420p ou nv12 dans un tampon contigu
+    // (pitch = largeur), agrandi au besoin, comme un envoi vers une texture streaming ;
+    // renvoie le nombre d'octets copiés
+    static size_t copyPlanes(const AVFrame* frame, std::vector<uint8_t>& destination);
+
+private:
+    bool ensureConvertedFrame(AVPixelFormat format, int width, int height);
+    bool convertPlanes(const AVFrame* frame, AVPixelFormat layout, uint8_t* const data[], const int linesize[]);
+    // yuv420p/yuvj420p/nv12/yuv420p10le : noyaux PixelKernels (10 -> 8 bits, plage, entrelacement)
+    void convertWithKernels(const AVFrame* frame, AVPixelFormat layout, bool fullRange,
+                            uint8_t* const data[], const int linesize[]);
+    // Autres formats : swscale
+    bool convertWithSwscale(const AVFrame* frame, AVPixelFormat layout, uint8_t* const data[], const int linesize[]);
+    void logConversion(const AVFrame* frame, AVPixelFormat layout, const char* method);
+
+    SwsContext* swsContext;
+    AVFrame* convertedFrame;
+    std::vector<uint8_t> chromaRows;
+    int loggedConversionFormat;
+};
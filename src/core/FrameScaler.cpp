@@ -0,0 +1,295 @@
+#include "FrameScaler.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <string>
+
+extern "C" {
+    #include <libavutil/opt.h>
+    #include <libavutil/pixdesc.h>
+}
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Alignement des lignes de sortie, suffisant pour les chargements SIMD et les textures
+static constexpr int LINE_ALIGNMENT = 64;
+
+FrameScaler::FrameScaler()
+    : targetWidth(0)
+    , targetHeight(0)
+    , threadCount(0)
+    , sourceWidth(0)
+    , sourceHeight(0)
+    , sourceFormat(AV_PIX_FMT_NONE)
+    , outputWidth(0)
+    , outputHeight(0)
+    , outputFormat(AV_PIX_FMT_NONE)
+    , path(Path::None)
+    , failed(false)
+    , halfBoxEnabled(true)
+    , swsContext(nullptr)
+    , bufferPool(nullptr)
+    , outputLinesize{0, 0, 0}
+    , outputPlaneOffset{0, 0, 0} {
+}
+
+FrameScaler::~FrameScaler() {
+    release();
+}
+
+void FrameScaler::release() {
+    if (swsContext) {
+        sws_freeContext(swsContext);
+        swsContext = nullptr;
+    }
+    // Les frames encore en file gardent leurs buffers : le pool n'est libéré qu'après elles
+    av_buffer_pool_uninit(&bufferPool);
+    path = Path::None;
+}
+
+void FrameScaler::setTarget(int maxWidth, int maxHeight, int threads) {
+    release();
+    targetWidth = maxWidth;
+    targetHeight = maxHeight;
+    threadCount = threads;
+    sourceWidth = 0;
+    sourceHeight = 0;
+    sourceFormat = AV_PIX_FMT_NONE;
+    failed = false;
+}
+
+void FrameScaler::fitWithin(int width, int height, int maxWidth, int maxHeight, int& outWidth, int& outHeight) {
+    if (maxWidth <= 0 || maxHeight <= 0 || (width <= maxWidth && height <= maxHeight)) {
+        outWidth = width;
+        outHeight = height;
+        return;
+    }
+
+    double ratio = std::min(static_cast<double>(maxWidth) / width, static_cast<double>(maxHeight) / height);
+    outWidth = std::max(2, static_cast<int>(width * ratio) & ~1);
+    outHeight = std::max(2, static_cast<int>(height * ratio) & ~1);
+}
+
+const char* FrameScaler::pathName(Path path) {
+    switch (path) {
+        case Path::HalfBox: return "2:1 box";
+        case Path::Swscale: return "swscale";
+        default: return "none";
+    }
+}
+
+bool FrameScaler::configure(const AVFrame* frame) {
+    release();
+    sourceWidth = frame->width;
+    sourceHeight = frame->height;
+    sourceFormat = frame->format;
+    failed = false;
+
+    fitWithin(sourceWidth, sourceHeight, targetWidth, targetHeight, outputWidth, outputHeight);
+    if (outputWidth == sourceWidth && outputHeight == sourceHeight) {
+        return true;
+    }
+
+    // Les formats que le Renderer envoie directement sont conservés, les autres convertis en yuv420p
+    bool directFormat = frame->format == AV_PIX_FMT_YUV420P || frame->format == AV_PIX_FMT_YUVJ420P ||
+                        frame->format == AV_PIX_FMT_NV12;
+    outputFormat = directFormat ? frame->format : AV_PIX_FMT_YUV420P;
+
+    if (halfBoxEnabled && directFormat && outputWidth * 2 == sourceWidth && outputHeight * 2 == sourceHeight) {
+        path = Path::HalfBox;
+    } else {
+        swsContext = sws_alloc_context();
+        if (swsContext) {
+            av_opt_set_int(swsContext, "srcw", sourceWidth, 0);
+            av_opt_set_int(swsContext, "srch", sourceHeight, 0);
+            av_opt_set_int(swsContext, "src_format", sourceFormat, 0);
+            av_opt_set_int(swsContext, "dstw", outputWidth, 0);
+            av_opt_set_int(swsContext, "dsth", outputHeight, 0);
+            av_opt_set_int(swsContext, "dst_format", outputFormat, 0);
+            av_opt_set_int(swsContext, "sws_flags", SWS_BILINEAR, 0);
+            av_opt_set_int(swsContext, "threads", threadCount, 0);
+        }
+        if (!swsContext || sws_init_context(swsContext, nullptr, nullptr) < 0) {
+            const char* name = av_get_pix_fmt_name(static_cast<AVPixelFormat>(sourceFormat));
+            Logger::logError("Cannot downscale " + std::string(name ? name : "unknown") + " frames, uploading them as is");
+            release();
+            failed = true;
+            return false;
+        }
+        path = Path::Swscale;
+    }
+
+    // Un seul buffer par frame pour tous les plans, recyclé par le pool
+    int chromaHeight = (outputHeight + 1) / 2;
+    outputLinesize[0] = FFALIGN(outputWidth, LINE_ALIGNMENT);
+    if (outputFormat == AV_PIX_FMT_NV12) {
+        outputLinesize[1] = FFALIGN(outputWidth, LINE_ALIGNMENT);
+        outputLinesize[2] = 0;
+    } else {
+        outputLinesize[1] = FFALIGN((outputWidth + 1) / 2, LINE_ALIGNMENT);
+        outputLinesize[2] = outputLinesize[1];
+    }
+    outputPlaneOffset[0] = 0;
+    outputPlaneOffset[1] = static_cast<size_t>(outputLinesize[0]) * outputHeight;
+    outputPlaneOffset[2] = outputPlaneOffset[1] + static_cast<size_t>(outputLinesize[1]) * chromaHeight;
+    size_t bufferSize = outputPlaneOffset[2] + static_cast<size_t>(outputLinesize[2]) * chromaHeight;
+    bufferPool = av_buffer_pool_init(bufferSize, nullptr);
+    if (!bufferPool) {
+        release();
+        failed = true;
+        return false;
+    }
+
+    Logger::logInfo("Downscaling " + std::to_string(sourceWidth) + "x" + std::to_string(sourceHeight) +
+                    " to " + std::to_string(outputWidth) + "x" + std::to_string(outputHeight) +
+                    " before upload (" + pathName(path) + ")");
+    return true;
+}
+
+bool FrameScaler::allocateOutput(AVFrame* output) {
+    output->buf[0] = av_buffer_pool_get(bufferPool);
+    if (!output->buf[0]) {
+        return false;
+    }
+    int planes = outputFormat == AV_PIX_FMT_NV12 ? 2 : 3;
+    for (int i = 0; i < planes; i++) {
+        output->data[i] = output->buf[0]->data + outputPlaneOffset[i];
+        output->linesize[i] = outputLinesize[i];
+    }
+    output->format = outputFormat;
+    output->width = outputWidth;
+    output->height = outputHeight;
+    return true;
+}
+
+bool FrameScaler::scale(AVFrame* frame) {
+    if (targetWidth <= 0 || targetHeight <= 0) {
+        return false;
+    }
+    if (frame->width != sourceWidth || frame->height != sourceHeight || frame->format != sourceFormat) {
+        configure(frame);
+    }
+    if (path == Path::None || failed) {
+        return false;
+    }
+
+    AVFrame* output = av_frame_alloc();
+    if (!output || !allocateOutput(output)) {
+        av_frame_free(&output);
+        return false;
+    }
+
+    bool scaled = path == Path::HalfBox ? scaleHalfBox(frame, output)
+                                        : sws_scale_frame(swsContext, output, frame) >= 0;
+    if (!scaled || av_frame_copy_props(output, frame) < 0) {
+        av_frame_free(&output);
+        return false;
+    }
+
+    // La frame source retourne au pool du décodeur dès maintenant
+    av_frame_unref(frame);
+    av_frame_move_ref(frame, output);
+    av_frame_free(&output);
+    return true;
+}
+
+bool FrameScaler::scaleHalfBox(const AVFrame* source, AVFrame* output) {
+    int chromaWidth = outputWidth / 2;
+    int chromaHeight = outputHeight / 2;
+
+    halvePlane(source->data[0], source->linesize[0], output->data[0], output->linesize[0],
+               outputWidth, outputHeight);
+    if (outputFormat == AV_PIX_FMT_NV12) {
+        halveInterleavedPlane(source->data[1], source->linesize[1], output->data[1], output->linesize[1],
+                              chromaWidth, chromaHeight);
+    } else {
+        for (int plane = 1; plane < 3; plane++) {
+            halvePlane(source->data[plane], source->linesize[plane], output->data[plane], output->linesize[plane],
+                       chromaWidth, chromaHeight);
+        }
+    }
+    return true;
+}
+
+void FrameScaler::halvePlane(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                             int dstWidth, int dstHeight) {
+    for (int y = 0; y < dstHeight; y++) {
+        const uint8_t* row0 = src + static_cast<ptrdiff_t>(2 * y) * srcStride;
+        const uint8_t* row1 = row0 + srcStride;
+        uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dstStride;
+        int x = 0;
+
+#if defined(__ARM_NEON)
+        // Sommes de paires horizontales, accumulées sur les deux lignes, puis arrondi (+2) >> 2
+        for (; x + 16 <= dstWidth; x += 16) {
+            uint16x8_t low = vpadalq_u8(vpaddlq_u8(vld1q_u8(row0 + 2 * x)), vld1q_u8(row1 + 2 * x));
+            uint16x8_t high = vpadalq_u8(vpaddlq_u8(vld1q_u8(row0 + 2 * x + 16)), vld1q_u8(row1 + 2 * x + 16));
+            vst1q_u8(out + x, vcombine_u8(vrshrn_n_u16(low, 2), vrshrn_n_u16(high, 2)));
+        }
+#elif defined(__SSE2__)
+        const __m128i evenMask = _mm_set1_epi16(0x00FF);
+        const __m128i rounding = _mm_set1_epi16(2);
+        for (; x + 16 <= dstWidth; x += 16) {
+            __m128i sums[2];
+            for (int half = 0; half < 2; half++) {
+                __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x + 16 * half));
+                __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x + 16 * half));
+                __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(top, evenMask), _mm_srli_epi16(top, 8)),
+                                            _mm_add_epi16(_mm_and_si128(bottom, evenMask), _mm_srli_epi16(bottom, 8)));
+                sums[half] = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(sums[0], sums[1]));
+        }
+#endif
+
+        for (; x < dstWidth; x++) {
+            out[x] = static_cast<uint8_t>((row0[2 * x] + row0[2 * x + 1] + row1[2 * x] + row1[2 * x + 1] + 2) >> 2);
+        }
+    }
+}
+
+void FrameScaler::halveInterleavedPlane(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                                        int dstWidth, int dstHeight) {
+    // dstWidth en paires UV : chaque paire de sortie moyenne deux paires sur deux lignes
+    for (int y = 0; y < dstHeight; y++) {
+        const uint8_t* row0 = src + static_cast<ptrdiff_t>(2 * y) * srcStride;
+        const uint8_t* row1 = row0 + srcStride;
+        uint8_t* out = dst + static_cast<ptrdiff_t>(y) * dstStride;
+        int x = 0;
+
+#if defined(__ARM_NEON)
+        for (; x + 8 <= dstWidth; x += 8) {
+            uint8x16x2_t top = vld2q_u8(row0 + 4 * x);
+            uint8x16x2_t bottom = vld2q_u8(row1 + 4 * x);
+            uint8x8x2_t result;
+            result.val[0] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(top.val[0]), bottom.val[0]), 2);
+            result.val[1] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(top.val[1]), bottom.val[1]), 2);
+            vst2_u8(out + 2 * x, result);
+        }
+#elif defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+        for (; x + 4 <= dstWidth; x += 4) {
+            __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 4 * x));
+            __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 4 * x));
+            // Paires UV en 16 bits, puis addition de chaque paire avec sa voisine (décalage de 4 octets)
+            __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+            __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+            low = _mm_shuffle_epi32(_mm_add_epi16(low, _mm_srli_si128(low, 4)), _MM_SHUFFLE(3, 1, 2, 0));
+            high = _mm_shuffle_epi32(_mm_add_epi16(high, _mm_srli_si128(high, 4)), _MM_SHUFFLE(3, 1, 2, 0));
+            __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(low, high), rounding), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 2 * x), _mm_packus_epi16(sum, sum));
+        }
+#endif
+
+        for (; x < dstWidth; x++) {
+            for (int c = 0; c < 2; c++) {
+                out[2 * x + c] = static_cast<uint8_t>((row0[4 * x + c] + row0[4 * x + 2 + c] +
+                                                       row1[4 * x + c] + row1[4 * x + 2 + c] + 2) >> 2);
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+extern "C" {
+    #include <libavutil/frame.h>
+    #include <libavutil/buffer.h>
+    #include <libswscale/swscale.h>
+}
+
+// Réduit les frames décodées à la taille d'affichage avant la file, pour que le
+// Renderer n'envoie au GPU que les pixels que l'écran peut montrer.
+// Le rapport exact 2:1 (4K vers 1080p) passe par un filtre boîte vectorisé ; les autres
+// rapports par swscale multithreadé. Utilisé par un seul thread à la fois.
+class FrameScaler {
+public:
+    enum class Path {
+        None,      // la source tient déjà dans la cible
+        HalfBox,   // moyenne 2x2, yuv420p/yuvj420p/nv12
+        Swscale
+    };
+
+    FrameScaler();
+    ~FrameScaler();
+
+    // 0x0 : pas de réduction. threads : threads de swscale, 0 = un par cœur
+    void setTarget(int maxWidth, int maxHeight, int threads = 0);
+    // Force swscale même pour le rapport 2:1 (comparaison des deux chemins)
+    void setHalfBoxEnabled(bool enabled) { halfBoxEnabled = enabled; }
+    // Remplace le contenu de frame par sa version réduite ; laisse la frame intacte si rien n'est à faire
+    bool scale(AVFrame* frame);
+    Path getPath() const { return path; }
+
+    // Plus grande taille (paire) de même rapport tenant dans maxWidth x maxHeight, sans agrandir
+    static void fitWithin(int width, int height, int maxWidth, int maxHeight, int& outWidth, int& outHeight);
+    static const char* pathName(Path path);
+
+    // Noyaux 2:1 exposés pour le benchmark : dst[x] = (a + b + c + d + 2) >> 2
+    static void halvePlane(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride, int dstWidth, int dstHeight);
+    static void halveInterleavedPlane(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride,
+                                      int dstWidth, int dstHeight);
+
+private:
+    bool configure(const AVFrame* frame);
+    void release();
+    bool allocateOutput(AVFrame* output);
+    bool scaleHalfBox(const AVFrame* source, AVFrame* output);
+
+    int targetWidth;
+    int targetHeight;
+    int threadCount;
+
+    // Géométrie de la source pour laquelle le chemin a été choisi
+    int sourceWidth;
+    int sourceHeight;
+    int sourceFormat;
+    int outputWidth;
+    int outputHeight;
+    int outputFormat;
+    Path path;
+    bool failed;
+    bool halfBoxEnabled;
+
+    SwsContext* swsContext;
+    AVBufferPool* bufferPool;
+    int outputLinesize[3];
+    size_t outputPlaneOffset[3];
+};
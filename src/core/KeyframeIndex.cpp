@@ -0,0 +1,240 @@
+#include "KeyframeIndex.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" {
+    #include <libavformat/avformat.h>
+}
+
+KeyframeIndex::KeyframeIndex()
+    : streamIndex(-1)
+    , ready(false)
+    , cancelled(false)
+    , mapping(nullptr)
+    , mappingSize(0)
+    , entries(nullptr)
+    , entryCount(0) {
+}
+
+KeyframeIndex::~KeyframeIndex() {
+    close();
+}
+
+std::string KeyframeIndex::sidecarPath(const std::string& path) {
+    return path + ".kfidx";
+}
+
+void KeyframeIndex::open(const std::string& path, int videoStreamIndex) {
+    close();
+    videoPath = path;
+    streamIndex = videoStreamIndex;
+
+    if (loadSidecar()) {
+        ready = true;
+        return;
+    }
+
+    cancelled = false;
+    buildThread = std::thread(&KeyframeIndex::buildThreadFunction, this);
+}
+
+void KeyframeIndex::close() {
+    cancelled = true;
+    if (buildThread.joinable()) {
+        buildThread.join();
+    }
+    ready = false;
+    unmap();
+    builtEntries.clear();
+    entries = nullptr;
+    entryCount = 0;
+}
+
+void KeyframeIndex::unmap() {
+    if (mapping) {
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+}
+
+bool KeyframeIndex::fillHeader(FileHeader& header) const {
+    struct stat info;
+    if (stat(videoPath.c_str(), &info) != 0) {
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.fileSize = static_cast<uint64_t>(info.st_size);
+    header.fileMtime = static_cast<int64_t>(info.st_mtime);
+    header.streamIndex = streamIndex;
+    return true;
+}
+
+bool KeyframeIndex::loadSidecar() {
+    FileHeader expected;
+    if (!fillHeader(expected)) {
+        return false;
+    }
+
+    std::string path = sidecarPath(videoPath);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    // Le fichier compagnon n'est valide que pour la même vidéo, non modifiée depuis
+    const FileHeader* header = static_cast<const FileHeader*>(data);
+    bool valid = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header->version == VERSION &&
+                 header->fileSize == expected.fileSize &&
+                 header->fileMtime == expected.fileMtime &&
+                 header->streamIndex == expected.streamIndex &&
+                 size == sizeof(FileHeader) + header->entryCount * sizeof(Entry);
+    if (!valid) {
+        munmap(data, size);
+        Logger::logInfo("Keyframe index " + path + " is stale, rebuilding");
+        return false;
+    }
+
+    mapping = data;
+    mappingSize = size;
+    entries = reinterpret_cast<const Entry*>(static_cast<const char*>(data) + sizeof(FileHeader));
+    entryCount = header->entryCount;
+    Logger::logInfo("Keyframe index loaded from " + path + ": " + std::to_string(entryCount) + " frames");
+    return true;
+}
+
+void KeyframeIndex::buildThreadFunction() {
+    auto start = std::chrono::steady_clock::now();
+    if (!build()) {
+        return;
+    }
+
+    entries = builtEntries.data();
+    entryCount = builtEntries.size();
+    ready = true;
+
+    size_t keyframes = std::count_if(builtEntries.begin(), builtEntries.end(),
+                                     [](const Entry& entry) { return entry.flags & KEYFRAME; });
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    Logger::logInfo("Keyframe index built in " + std::to_string(elapsed.count()) + " ms: " +
+                    std::to_string(entryCount) + " frames, " + std::to_string(keyframes) + " keyframes");
+
+    if (!saveSidecar()) {
+        Logger::logInfo("Could not write " + sidecarPath(videoPath) + ", the index will be rebuilt next time");
+    }
+}
+
+bool KeyframeIndex::build() {
+    // Démultiplexeur séparé : la lecture seule des paquets, sans décodage, suffit
+    AVFormatContext* formatContext = nullptr;
+    if (avformat_open_input(&formatContext, videoPath.c_str(), nullptr, nullptr) < 0) {
+        Logger::logError("Keyframe index: could not open " + videoPath);
+        return false;
+    }
+    if (streamIndex < 0 || static_cast<unsigned>(streamIndex) >= formatContext->nb_streams) {
+        avformat_close_input(&formatContext);
+        return false;
+    }
+
+    // Seul le flux vidéo est lu
+    for (unsigned i = 0; i < formatContext->nb_streams; i++) {
+        formatContext->streams[i]->discard = static_cast<int>(i) == streamIndex ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    std::vector<Entry> frames;
+    while (!cancelled && packet && av_read_frame(formatContext, packet) >= 0) {
+        if (packet->stream_index == streamIndex) {
+            int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            if (pts != AV_NOPTS_VALUE) {
+                uint32_t flags = (packet->flags & AV_PKT_FLAG_KEY) ? KEYFRAME : 0;
+                frames.push_back({pts, packet->pos, flags, 0});
+            }
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    avformat_close_input(&formatContext);
+
+    if (cancelled || frames.empty()) {
+        return false;
+    }
+
+    std::sort(frames.begin(), frames.end(), [](const Entry& a, const Entry& b) { return a.pts < b.pts; });
+    builtEntries = std::move(frames);
+    return true;
+}
+
+bool KeyframeIndex::saveSidecar() const {
+    FileHeader header;
+    if (!fillHeader(header)) {
+        return false;
+    }
+    header.entryCount = builtEntries.size();
+
+    // Écriture dans un fichier temporaire puis renommage : un lecteur ne voit jamais un index partiel
+    std::string path = sidecarPath(videoPath);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(builtEntries.data()), builtEntries.size() * sizeof(Entry));
+        if (!file) {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+bool KeyframeIndex::getFramePts(size_t frameNumber, int64_t& pts) const {
+    if (!ready || frameNumber >= entryCount) {
+        return false;
+    }
+    pts = entries[frameNumber].pts;
+    return true;
+}
+
+const KeyframeIndex::Entry* KeyframeIndex::findKeyframe(int64_t targetPts) const {
+    if (!ready || entryCount == 0) {
+        return nullptr;
+    }
+
+    const Entry* end = entries + entryCount;
+    const Entry* it = std::upper_bound(entries, end, targetPts,
+                                       [](int64_t pts, const Entry& entry) { return pts < entry.pts; });
+    while (it != entries) {
+        --it;
+        if (it->flags & KEYFRAME) {
+            return it;
+        }
+    }
+    return nullptr;
+}
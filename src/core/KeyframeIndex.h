@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Index PTS des frames vidéo d'un fichier, trié dans l'ordre de présentation.
+// Construit une fois en arrière-plan, puis enregistré à côté de la vidéo (<video>.kfidx)
+// et projeté en mémoire (mmap) aux lancements suivants.
+class KeyframeIndex {
+public:
+    struct Entry {
+        int64_t pts;       // en time base du flux vidéo
+        int64_t pos;       // position du paquet dans le fichier, -1 si inconnue
+        uint32_t flags;
+        uint32_t reserved;
+    };
+    static constexpr uint32_t KEYFRAME = 1;
+
+    KeyframeIndex();
+    ~KeyframeIndex();
+
+    // Charge le fichier compagnon s'il correspond encore à la vidéo, sinon lance la construction
+    void open(const std::string& path, int videoStreamIndex);
+    void close();
+
+    bool isReady() const { return ready; }
+    size_t getFrameCount() const { return ready ? entryCount : 0; }
+    // PTS de la n-ième frame dans l'ordre de présentation
+    bool getFramePts(size_t frameNumber, int64_t& pts) const;
+    // Dernière keyframe dont le PTS est inférieur ou égal à targetPts, nullptr si inconnue
+    const Entry* findKeyframe(int64_t targetPts) const;
+
+    static std::string sidecarPath(const std::string& path);
+
+private:
+    // En-tête du fichier compagnon, suivi de entryCount entrées
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t fileSize;
+        int64_t fileMtime;
+        int32_t streamIndex;
+        uint32_t reserved;
+        uint64_t entryCount;
+    };
+    static constexpr char MAGIC[4] = {'V', 'P', 'K', 'I'};
+    static constexpr uint32_t VERSION = 1;
+
+    bool loadSidecar();
+    void buildThreadFunction();
+    bool build();
+    bool saveSidecar() const;
+    bool fillHeader(FileHeader& header) const;
+    void unmap();
+
+    std::string videoPath;
+    int streamIndex;
+
+    std::thread buildThread;
+    std::atomic<bool> ready;
+    std::atomic<bool> cancelled;
+
+    // Entrées projetées depuis le fichier compagnon, ou construites en mémoire
+    void* mapping;
+    size_t mappingSize;
+    std::vector<Entry> builtEntries;
+    const Entry* entries;
+    size_t entryCount;
+};
@@ -0,0 +1,101 @@
+#include "LateFramePolicy.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <string>
+
+LateFramePolicy::LateFramePolicy()
+    : frameDuration(1.0 / 30.0)
+    , degradationLevel(0)
+    , consecutiveDrops(0)
+    , calmWindows(0)
+    , presentedFrames(0)
+    , droppedFrames(0)
+    , windowStart(std::chrono::steady_clock::now())
+    , windowLatenessSum(0.0)
+    , windowFrames(0)
+    , windowDrops(0)
+    , lastReport(std::chrono::steady_clock::now())
+    , reportLatenessSum(0.0)
+    , reportMaxLateness(0.0)
+    , reportFrames(0)
+    , lastAverageLateness(0.0)
+    , lastMaxLateness(0.0) {
+}
+
+LateFramePolicy::Decision LateFramePolicy::evaluate(double lateness) {
+    double late = std::max(0.0, lateness);
+    windowLatenessSum += late;
+    windowFrames++;
+    reportLatenessSum += late;
+    reportMaxLateness = std::max(reportMaxLateness, late);
+    reportFrames++;
+
+    // Une frame sur MAX_CONSECUTIVE_DROPS + 1 est toujours présentée pour que l'image avance
+    Decision decision = Decision::Present;
+    if (late > DROP_THRESHOLD * frameDuration && consecutiveDrops < MAX_CONSECUTIVE_DROPS) {
+        decision = Decision::Drop;
+        consecutiveDrops++;
+        droppedFrames++;
+        windowDrops++;
+    } else {
+        consecutiveDrops = 0;
+        presentedFrames++;
+    }
+
+    if (std::chrono::steady_clock::now() - windowStart >= WINDOW) {
+        updateDegradation();
+    }
+    return decision;
+}
+
+void LateFramePolicy::updateDegradation() {
+    double averageLateness = windowFrames > 0 ? windowLatenessSum / windowFrames : 0.0;
+    double dropRatio = windowFrames > 0 ? static_cast<double>(windowDrops) / windowFrames : 0.0;
+
+    if (averageLateness > ESCALATE_THRESHOLD * frameDuration || dropRatio > ESCALATE_DROP_RATIO) {
+        calmWindows = 0;
+        if (degradationLevel < MAX_DEGRADATION_LEVEL) {
+            degradationLevel++;
+            Logger::logInfo("Playback falling behind (" + std::to_string(static_cast<int>(averageLateness * 1000)) +
+                            " ms late), decoder degradation level " + std::to_string(degradationLevel));
+        }
+    } else if (averageLateness < RECOVER_THRESHOLD * frameDuration && windowDrops == 0) {
+        // Redescendre lentement : une dégradation relâchée trop tôt ferait osciller
+        if (degradationLevel > 0 && ++calmWindows >= CALM_WINDOWS_TO_RECOVER) {
+            calmWindows = 0;
+            degradationLevel--;
+            Logger::logInfo("Playback caught up, decoder degradation level " + std::to_string(degradationLevel));
+        }
+    } else {
+        calmWindows = 0;
+    }
+
+    windowStart = std::chrono::steady_clock::now();
+    windowLatenessSum = 0.0;
+    windowFrames = 0;
+    windowDrops = 0;
+}
+
+LateFramePolicy::Stats LateFramePolicy::getStats() const {
+    return {presentedFrames, droppedFrames, degradationLevel, lastAverageLateness * 1000.0, lastMaxLateness * 1000.0};
+}
+
+void LateFramePolicy::report(uint64_t degradedFrames) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastReport < std::chrono::seconds(1)) {
+        return;
+    }
+
+    lastAverageLateness = reportFrames > 0 ? reportLatenessSum / reportFrames : 0.0;
+    lastMaxLateness = reportMaxLateness;
+    Logger::logPerformance("Late frames: presented " + std::to_string(presentedFrames) +
+                           ", dropped " + std::to_string(droppedFrames) +
+                           ", decoded degraded " + std::to_string(degradedFrames) +
+                           " | lateness avg " + std::to_string(static_cast<int>(lastAverageLateness * 1000)) +
+                           " ms, max " + std::to_string(static_cast<int>(lastMaxLateness * 1000)) +
+                           " ms | degradation level " + std::to_string(degradationLevel));
+    reportLatenessSum = 0.0;
+    reportMaxLateness = 0.0;
+    reportFrames = 0;
+    lastReport = now;
+}
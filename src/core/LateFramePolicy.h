@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Politique appliquée aux frames en retard, côté consommateur.
+// Une frame déjà en retard de plus d'une frame est jetée avant l'envoi au GPU ; si le
+// retard persiste, le niveau de dégradation du décodeur augmente, puis redescend
+// par paliers une fois le retard résorbé.
+class LateFramePolicy {
+public:
+    enum class Decision {
+        Present,
+        Drop
+    };
+
+    struct Stats {
+        uint64_t presentedFrames;
+        uint64_t droppedFrames;
+        int degradationLevel;
+        double averageLatenessMs;
+        double maxLatenessMs;
+    };
+
+    static constexpr int MAX_DEGRADATION_LEVEL = 4;
+
+    LateFramePolicy();
+
+    void setFrameDuration(double seconds) { frameDuration = seconds; }
+    // lateness : retard de la frame sur l'horloge de présentation, en secondes (négatif : en avance)
+    Decision evaluate(double lateness);
+    int getDegradationLevel() const { return degradationLevel; }
+    Stats getStats() const;
+    // Journalise le bilan une fois par seconde ; degradedFrames est compté par le décodeur
+    void report(uint64_t degradedFrames);
+
+private:
+    void updateDegradation();
+
+    double frameDuration;
+    int degradationLevel;
+    int consecutiveDrops;
+    int calmWindows;
+
+    uint64_t presentedFrames;
+    uint64_t droppedFrames;
+
+    // Fenêtre courante d'évaluation de la dégradation
+    std::chrono::steady_clock::time_point windowStart;
+    double windowLatenessSum;
+    uint64_t windowFrames;
+    uint64_t windowDrops;
+
+    // Fenêtre courante du rapport
+    std::chrono::steady_clock::time_point lastReport;
+    double reportLatenessSum;
+    double reportMaxLateness;
+    uint64_t reportFrames;
+    double lastAverageLateness;
+    double lastMaxLateness;
+
+    // Seuils exprimés en durées de frame
+    static constexpr double DROP_THRESHOLD = 1.0;
+    static constexpr double ESCALATE_THRESHOLD = 2.0;
+    static constexpr double RECOVER_THRESHOLD = 0.5;
+    static constexpr double ESCALATE_DROP_RATIO = 0.25;
+    static constexpr int MAX_CONSECUTIVE_DROPS = 4;
+    static constexpr int CALM_WINDOWS_TO_RECOVER = 4;
+    static constexpr std::chrono::milliseconds WINDOW{500};
+};
@@ -0,0 +1,381 @@
+#include "LoopCache.h"
+#include "VideoDecoder.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+extern "C" {
+    #include <libavutil/imgutils.h>
+}
+
+LoopCache::LoopCache()
+    : maxBytes(0)
+    , expectedFrames(0)
+    , timeBase{1, 1}
+    , expectAudio(false)
+    , state(State::Filling)
+    , storage(LoopCacheStorage::Raw)
+    , totalBytes(0)
+    , videoFrameCount(0)
+    , audioFrameCount(0)
+    , clipSeconds(0.0)
+    , videoBytes(0)
+    , storageChosen(false)
+    , encoder(nullptr)
+    , replayDecoder(nullptr)
+    , videoSealed(false)
+    , audioBytes(0)
+    , audioSealed(false)
+    , videoComplete(false)
+    , audioComplete(false) {
+}
+
+LoopCache::~LoopCache() {
+    clear();
+}
+
+void LoopCache::reset(size_t budgetBytes, size_t estimatedFrames, AVRational videoTimeBase, bool withAudio) {
+    clear();
+    maxBytes = budgetBytes;
+    expectedFrames = estimatedFrames;
+    timeBase = videoTimeBase;
+    expectAudio = withAudio;
+}
+
+void LoopCache::clear() {
+    freeVideoFrames();
+    freeAudioFrames();
+    if (encoder) {
+        avcodec_free_context(&encoder);
+    }
+    if (replayDecoder) {
+        avcodec_free_context(&replayDecoder);
+    }
+    state = State::Filling;
+    storage = LoopCacheStorage::Raw;
+    storageChosen = false;
+    clipSeconds = 0.0;
+    videoSealed = false;
+    audioSealed = false;
+    videoComplete = false;
+    audioComplete = false;
+}
+
+void LoopCache::freeVideoFrames() {
+    for (CachedVideoFrame& cached : videoFrames) {
+        av_frame_free(&cached.frame);
+        av_packet_free(&cached.packet);
+    }
+    videoFrames.clear();
+    totalBytes -= videoBytes;
+    videoBytes = 0;
+    videoFrameCount = 0;
+}
+
+void LoopCache::freeAudioFrames() {
+    for (AVFrame* frame : audioFrames) {
+        av_frame_free(&frame);
+    }
+    audioFrames.clear();
+    totalBytes -= audioBytes;
+    audioBytes = 0;
+    audioFrameCount = 0;
+}
+
+void LoopCache::chooseStorage(const AVFrame* frame) {
+    storageChosen = true;
+
+    size_t frameBytes = av_image_get_buffer_size(static_cast<AVPixelFormat>(frame->format),
+                                                 frame->width, frame->height, 1);
+    size_t rawEstimate = frameBytes * expectedFrames;
+    if (rawEstimate <= maxBytes) {
+        storage = LoopCacheStorage::Raw;
+    } else if (openEncoder(frame)) {
+        storage = LoopCacheStorage::Lossless;
+    } else {
+        Logger::logInfo("Loop cache: no lossless encoder for this pixel format, caching raw frames");
+        storage = LoopCacheStorage::Raw;
+    }
+
+    Logger::logInfo("Loop cache: " + std::string(storageName(storage)) + " storage, raw clip estimated at " +
+                    std::to_string(rawEstimate / (1024 * 1024)) + " MB for a budget of " +
+                    std::to_string(maxBytes / (1024 * 1024)) + " MB");
+}
+
+bool LoopCache::openEncoder(const AVFrame* frame) {
+    // Ut Video : intra, sans perte et conçu pour encoder/décoder plus vite que le temps réel
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_UTVIDEO);
+    if (!codec) {
+        return false;
+    }
+
+    encoder = avcodec_alloc_context3(codec);
+    if (!encoder) {
+        return false;
+    }
+    encoder->width = frame->width;
+    encoder->height = frame->height;
+    encoder->pix_fmt = static_cast<AVPixelFormat>(frame->format);
+    encoder->time_base = timeBase;
+    encoder->thread_count = 1;  // une frame entrante, un paquet sortant
+
+    if (avcodec_open2(encoder, codec, nullptr) < 0) {
+        avcodec_free_context(&encoder);
+        return false;
+    }
+    return true;
+}
+
+bool LoopCache::openReplayDecoder() {
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_UTVIDEO);
+    if (!codec || !encoder) {
+        return false;
+    }
+
+    replayDecoder = avcodec_alloc_context3(codec);
+    if (!replayDecoder) {
+        return false;
+    }
+    replayDecoder->width = encoder->width;
+    replayDecoder->height = encoder->height;
+    replayDecoder->pix_fmt = encoder->pix_fmt;
+    replayDecoder->thread_type = FF_THREAD_SLICE;  // pas de délai, contrairement au frame threading
+    replayDecoder->thread_count = 0;
+    if (encoder->extradata_size > 0) {
+        replayDecoder->extradata = static_cast<uint8_t*>(
+            av_mallocz(encoder->extradata_size + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (!replayDecoder->extradata) {
+            avcodec_free_context(&replayDecoder);
+            return false;
+        }
+        memcpy(replayDecoder->extradata, encoder->extradata, encoder->extradata_size);
+        replayDecoder->extradata_size = encoder->extradata_size;
+    }
+
+    if (avcodec_open2(replayDecoder, codec, nullptr) < 0) {
+        Logger::logError("Loop cache: failed to open the lossless replay decoder");
+        avcodec_free_context(&replayDecoder);
+        return false;
+    }
+    return true;
+}
+
+bool LoopCache::reserve(size_t bytes, bool force) {
+    if (!force && totalBytes + bytes > maxBytes) {
+        abandon("clip exceeds the cache budget");
+        return false;
+    }
+    totalBytes += bytes;
+    return true;
+}
+
+void LoopCache::abandon(const char* reason) {
+    State expected = State::Filling;
+    if (state.compare_exchange_strong(expected, State::Abandoned)) {
+        Logger::logInfo(std::string("Loop cache abandoned: ") + reason + ", every loop will be decoded");
+    }
+    notifyCompletion();
+}
+
+void LoopCache::storeVideoFrame(const AVFrame* frame) {
+    if (state != State::Filling) {
+        if (state == State::Abandoned) {
+            freeVideoFrames();
+        }
+        return;
+    }
+    if (frame->hw_frames_ctx) {
+        abandon("hardware frames cannot be cached");
+        freeVideoFrames();
+        return;
+    }
+    if (!storageChosen) {
+        chooseStorage(frame);
+    }
+
+    CachedVideoFrame cached{nullptr, nullptr, frame->pts, frame->duration};
+    size_t bytes = 0;
+    if (storage == LoopCacheStorage::Raw) {
+        // Copie dans des buffers propres au cache : garder des références bloquerait
+        // le pool de buffers du décodeur (limité sur les décodeurs matériels)
+        cached.frame = av_frame_alloc();
+        if (!cached.frame) {
+            return;
+        }
+        cached.frame->format = frame->format;
+        cached.frame->width = frame->width;
+        cached.frame->height = frame->height;
+        if (av_frame_get_buffer(cached.frame, 0) < 0 || av_frame_copy(cached.frame, frame) < 0) {
+            av_frame_free(&cached.frame);
+            abandon("frame copy failed");
+            freeVideoFrames();
+            return;
+        }
+        av_frame_copy_props(cached.frame, frame);
+        bytes = VideoDecoder::frameMemorySize(cached.frame);
+    } else {
+        cached.packet = av_packet_alloc();
+        if (!cached.packet || avcodec_send_frame(encoder, frame) < 0 ||
+            avcodec_receive_packet(encoder, cached.packet) < 0) {
+            av_packet_free(&cached.packet);
+            abandon("lossless encoding failed");
+            freeVideoFrames();
+            return;
+        }
+        bytes = cached.packet->size;
+    }
+
+    if (!reserve(bytes, videoSealed)) {
+        av_frame_free(&cached.frame);
+        av_packet_free(&cached.packet);
+        freeVideoFrames();
+        return;
+    }
+    videoFrames.push_back(cached);
+    videoBytes += bytes;
+    videoFrameCount = videoFrames.size();
+}
+
+void LoopCache::restartVideo() {
+    // Seek pendant le premier passage : le cache doit repartir du début du clip
+    if (state == State::Filling) {
+        freeVideoFrames();
+    }
+}
+
+void LoopCache::completeVideo() {
+    if (state == State::Filling && videoFrames.empty()) {
+        abandon("no video frame was cached");
+    }
+    if (state != State::Filling) {
+        if (state == State::Abandoned) {
+            freeVideoFrames();
+        }
+        return;
+    }
+
+    // Durée d'une itération : de la première frame à la fin de la dernière
+    int64_t firstPts = videoFrames.front().pts;
+    int64_t lastPts = firstPts;
+    int64_t lastDuration = 0;
+    for (const CachedVideoFrame& cached : videoFrames) {
+        firstPts = std::min(firstPts, cached.pts);
+        if (cached.pts >= lastPts) {
+            lastPts = cached.pts;
+            lastDuration = cached.duration;
+        }
+    }
+    if (lastDuration <= 0 && videoFrames.size() > 1) {
+        lastDuration = (lastPts - firstPts) / static_cast<int64_t>(videoFrames.size() - 1);
+    }
+    clipSeconds = (lastPts + lastDuration - firstPts) * av_q2d(timeBase);
+
+    std::lock_guard<std::mutex> lock(completionMutex);
+    videoComplete = true;
+    notifyCompletion();
+}
+
+AVFrame* LoopCache::replayVideoFrame(size_t index) {
+    const CachedVideoFrame& cached = videoFrames[index];
+    if (cached.frame) {
+        return av_frame_clone(cached.frame);  // nouvelle référence, sans copie des pixels
+    }
+
+    if (!replayDecoder && !openReplayDecoder()) {
+        return nullptr;
+    }
+    AVFrame* frame = av_frame_alloc();
+    if (!frame) {
+        return nullptr;
+    }
+    if (avcodec_send_packet(replayDecoder, cached.packet) < 0 ||
+        avcodec_receive_frame(replayDecoder, frame) < 0) {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+    frame->pts = cached.pts;
+    return frame;
+}
+
+void LoopCache::storeAudioFrame(const AVFrame* frame) {
+    if (state != State::Filling) {
+        if (state == State::Abandoned) {
+            freeAudioFrames();
+        }
+        return;
+    }
+
+    AVFrame* cached = av_frame_clone(frame);
+    if (!cached) {
+        return;
+    }
+    size_t bytes = VideoDecoder::frameMemorySize(cached);
+    if (!reserve(bytes, audioSealed)) {
+        av_frame_free(&cached);
+        freeAudioFrames();
+        return;
+    }
+    audioFrames.push_back(cached);
+    audioBytes += bytes;
+    audioFrameCount = audioFrames.size();
+}
+
+void LoopCache::restartAudio() {
+    if (state == State::Filling) {
+        freeAudioFrames();
+    }
+}
+
+void LoopCache::completeAudio() {
+    if (state == State::Abandoned) {
+        freeAudioFrames();
+    }
+
+    std::lock_guard<std::mutex> lock(completionMutex);
+    audioComplete = true;
+    notifyCompletion();
+}
+
+void LoopCache::notifyCompletion() {
+    // Appelé sous completionMutex, sauf depuis abandon() : un abandon concurrent ne doit pas
+    // être écrasé, les frames étant alors déjà libérées
+    State expected = State::Filling;
+    if (videoComplete && (audioComplete || !expectAudio) &&
+        state.compare_exchange_strong(expected, State::Complete)) {
+        Logger::logInfo("Loop cache complete: " + std::to_string(videoFrameCount.load()) + " video frames, " +
+                        std::to_string(audioFrameCount.load()) + " audio frames, " +
+                        std::to_string(totalBytes.load() / (1024 * 1024)) + " MB (" +
+                        storageName(storage) + ")");
+    }
+    completionCondition.notify_all();
+}
+
+bool LoopCache::awaitCompletion(const std::atomic<bool>& running) {
+    std::unique_lock<std::mutex> lock(completionMutex);
+    while (running && state == State::Filling) {
+        completionCondition.wait_for(lock, std::chrono::milliseconds(100));
+    }
+    return state == State::Complete;
+}
+
+LoopCache::Stats LoopCache::getStats() const {
+    return {state, storage, totalBytes, videoFrameCount, audioFrameCount};
+}
+
+const char* LoopCache::stateName(State state) {
+    switch (state) {
+        case State::Filling: return "filling";
+        case State::Complete: return "complete";
+        case State::Abandoned: return "abandoned";
+    }
+    return "unknown";
+}
+
+const char* LoopCache::storageName(LoopCacheStorage storage) {
+    switch (storage) {
+        case LoopCacheStorage::Raw: return "raw";
+        case LoopCacheStorage::Lossless: return "lossless";
+    }
+    return "unknown";
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+}
+
+enum class LoopCacheStorage {
+    Raw,       // frames décodées telles quelles
+    Lossless   // frames recompressées (Ut Video) lorsque le clip brut dépasse le budget
+};
+
+// Conserve les frames décodées du premier passage pour rejouer les boucles suivantes sans
+// redécoder le fichier. La piste vidéo n'est écrite et relue que par le thread de décodage
+// vidéo, la piste audio que par le thread audio ; seuls le compteur d'octets et l'état sont partagés.
+class LoopCache {
+public:
+    enum class State {
+        Filling,
+        Complete,
+        Abandoned   // budget dépassé : le lecteur redécode chaque boucle
+    };
+
+    struct Stats {
+        State state;
+        LoopCacheStorage storage;
+        size_t bytes;
+        size_t videoFrames;
+        size_t audioFrames;
+    };
+
+    LoopCache();
+    ~LoopCache();
+
+    // Avant le démarrage des threads de décodage
+    void reset(size_t budgetBytes, size_t estimatedFrames, AVRational videoTimeBase, bool withAudio);
+    // Après leur arrêt
+    void clear();
+
+    // Thread vidéo. sealVideo() marque la fin du premier passage : les dernières frames
+    // rendues par le décodeur sont acceptées même au-delà du budget
+    void storeVideoFrame(const AVFrame* frame);
+    void restartVideo();
+    void sealVideo() { videoSealed = true; }
+    void completeVideo();
+    size_t getVideoFrameCount() const { return videoFrames.size(); }
+    // Nouvelle frame, avec son PTS d'origine ; à libérer par l'appelant
+    AVFrame* replayVideoFrame(size_t index);
+
+    // Thread audio
+    void storeAudioFrame(const AVFrame* frame);
+    void restartAudio();
+    void sealAudio() { audioSealed = true; }
+    void completeAudio();
+    const std::vector<AVFrame*>& getAudioFrames() const { return audioFrames; }
+
+    // Attend que les deux pistes soient complètes : vrai si le cache peut être rejoué
+    bool awaitCompletion(const std::atomic<bool>& running);
+
+    // Le premier passage ne couvre plus le clip entier (seek en cours de remplissage)
+    void invalidate(const char* reason) { abandon(reason); }
+
+    bool isFilling() const { return state == State::Filling; }
+    bool isAbandoned() const { return state == State::Abandoned; }
+    // Durée d'une itération, valide une fois le cache complet
+    double getClipSeconds() const { return clipSeconds; }
+    Stats getStats() const;
+
+    static const char* stateName(State state);
+    static const char* storageName(LoopCacheStorage storage);
+
+private:
+    struct CachedVideoFrame {
+        AVFrame* frame;     // stockage brut
+        AVPacket* packet;   // stockage compressé
+        int64_t pts;
+        int64_t duration;
+    };
+
+    void chooseStorage(const AVFrame* frame);
+    bool openEncoder(const AVFrame* frame);
+    bool openReplayDecoder();
+    bool reserve(size_t bytes, bool force);
+    void abandon(const char* reason);
+    void freeVideoFrames();
+    void freeAudioFrames();
+    void notifyCompletion();
+
+    size_t maxBytes;
+    size_t expectedFrames;
+    AVRational timeBase;
+    bool expectAudio;
+
+    std::atomic<State> state;
+    std::atomic<LoopCacheStorage> storage;
+    std::atomic<size_t> totalBytes;
+    std::atomic<size_t> videoFrameCount;
+    std::atomic<size_t> audioFrameCount;
+    double clipSeconds;
+
+    // Piste vidéo
+    std::vector<CachedVideoFrame> videoFrames;
+    size_t videoBytes;
+    bool storageChosen;
+    AVCodecContext* encoder;
+    AVCodecContext* replayDecoder;
+    bool videoSealed;
+
+    // Piste audio
+    std::vector<AVFrame*> audioFrames;
+    size_t audioBytes;
+    bool audioSealed;
+
+    bool videoComplete;
+    bool audioComplete;
+    std::mutex completionMutex;
+    std::condition_variable completionCondition;
+};
@@ -0,0 +1,222 @@
+#include "LoopPreroller.h"
+#include "VideoDecoder.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+
+LoopPreroller::LoopPreroller()
+    : videoStreamIndex(-1)
+    , audioStreamIndex(-1)
+    , videoTimeBase{1, 1}
+    , isRunning(false)
+    , ready(false)
+    , videoBytes(0)
+    , firstPts(AV_NOPTS_VALUE)
+    , resumePts(AV_NOPTS_VALUE)
+    , resumeAtKeyframe(false) {
+}
+
+LoopPreroller::~LoopPreroller() {
+    stop();
+}
+
+void LoopPreroller::start(const std::string& path, const DecoderConfig& decoderConfig,
+                          int videoIndex, int audioIndex) {
+    stop();
+    config = decoderConfig;
+    videoStreamIndex = videoIndex;
+    audioStreamIndex = audioIndex;
+    // Thread de fond : swscale sans threads supplémentaires
+    scaler.setTarget(config.downscaleWidth, config.downscaleHeight, 1);
+    isRunning = true;
+    prerollThread = std::thread(&LoopPreroller::prerollThreadFunction, this, path);
+}
+
+void LoopPreroller::stop() {
+    isRunning = false;
+    if (prerollThread.joinable()) {
+        prerollThread.join();
+    }
+    freeFrames();
+}
+
+void LoopPreroller::freeFrames() {
+    for (AVFrame* frame : videoFrames) {
+        av_frame_free(&frame);
+    }
+    for (AVFrame* frame : audioFrames) {
+        av_frame_free(&frame);
+    }
+    videoFrames.clear();
+    audioFrames.clear();
+    videoBytes = 0;
+    firstPts = AV_NOPTS_VALUE;
+    resumePts = AV_NOPTS_VALUE;
+    resumeAtKeyframe = false;
+    ready = false;
+}
+
+AVCodecContext* LoopPreroller::openDecoder(AVStream* stream) {
+    // Décodeur logiciel : les buffers d'un décodeur matériel ne doivent pas rester bloqués ici
+    const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!codec) {
+        return nullptr;
+    }
+
+    AVCodecContext* context = avcodec_alloc_context3(codec);
+    if (!context) {
+        return nullptr;
+    }
+
+    if (avcodec_parameters_to_context(context, stream->codecpar) < 0) {
+        avcodec_free_context(&context);
+        return nullptr;
+    }
+    context->pkt_timebase = stream->time_base;
+    if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+        VideoDecoder::configureThreading(context, config);
+    }
+
+    if (avcodec_open2(context, codec, nullptr) < 0) {
+        avcodec_free_context(&context);
+        return nullptr;
+    }
+    return context;
+}
+
+void LoopPreroller::receiveVideoFrames(AVCodecContext* context, AVFrame* frame) {
+    size_t maxBytes = config.videoQueue.maxBytes / 2;
+
+    while (avcodec_receive_frame(context, frame) >= 0) {
+        if (frame->pts == AV_NOPTS_VALUE ||
+            (resumePts != AV_NOPTS_VALUE && frame->pts >= resumePts)) {
+            av_frame_unref(frame);
+            continue;
+        }
+
+        if (firstPts == AV_NOPTS_VALUE) {
+            firstPts = frame->pts;
+        }
+
+        double coveredSeconds = (frame->pts - firstPts) * av_q2d(videoTimeBase);
+        if (resumePts == AV_NOPTS_VALUE &&
+            (videoBytes >= maxBytes || coveredSeconds >= config.loopPrerollSeconds)) {
+            // Limite atteinte avant la keyframe suivante : le décodeur principal
+            // repartira du début et écartera les frames déjà couvertes
+            resumePts = frame->pts;
+            resumeAtKeyframe = false;
+            av_frame_unref(frame);
+            continue;
+        }
+
+        scaler.scale(frame);
+        videoBytes += VideoDecoder::frameMemorySize(frame);
+        AVFrame* standby = av_frame_alloc();
+        av_frame_move_ref(standby, frame);
+        videoFrames.push_back(standby);
+    }
+}
+
+void LoopPreroller::receiveAudioFrames(AVCodecContext* context, AVFrame* frame) {
+    while (avcodec_receive_frame(context, frame) >= 0) {
+        AVFrame* standby = av_frame_alloc();
+        av_frame_move_ref(standby, frame);
+        audioFrames.push_back(standby);
+    }
+}
+
+void LoopPreroller::prerollThreadFunction(std::string path) {
+    auto start = std::chrono::steady_clock::now();
+    AVFormatContext* formatContext = nullptr;
+    AVCodecContext* videoContext = nullptr;
+    AVCodecContext* audioContext = nullptr;
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+
+    if (avformat_open_input(&formatContext, path.c_str(), nullptr, nullptr) < 0 ||
+        avformat_find_stream_info(formatContext, nullptr) < 0) {
+        Logger::logError("Loop preroll: could not open video file");
+    } else {
+        videoTimeBase = formatContext->streams[videoStreamIndex]->time_base;
+        videoContext = openDecoder(formatContext->streams[videoStreamIndex]);
+        if (audioStreamIndex >= 0) {
+            audioContext = openDecoder(formatContext->streams[audioStreamIndex]);
+        }
+    }
+
+    bool keyframeSeen = false;
+    bool reachedEnd = false;
+    while (isRunning && videoContext) {
+        if (av_read_frame(formatContext, packet) < 0) {
+            reachedEnd = true;
+            break;
+        }
+
+        if (packet->stream_index == videoStreamIndex && resumePts == AV_NOPTS_VALUE) {
+            bool keyframe = packet->flags & AV_PKT_FLAG_KEY;
+            if (keyframe && keyframeSeen && packet->pts != AV_NOPTS_VALUE) {
+                // Début du GOP suivant : on récupère les frames du premier GOP encore dans le décodeur
+                resumePts = packet->pts;
+                resumeAtKeyframe = true;
+                avcodec_send_packet(videoContext, nullptr);
+            } else {
+                keyframeSeen = keyframeSeen || keyframe;
+                avcodec_send_packet(videoContext, packet);
+            }
+            receiveVideoFrames(videoContext, frame);
+        } else if (packet->stream_index == audioStreamIndex && audioContext) {
+            AVRational audioTimeBase = formatContext->streams[audioStreamIndex]->time_base;
+            if (resumePts != AV_NOPTS_VALUE && packet->pts != AV_NOPTS_VALUE &&
+                packet->pts >= av_rescale_q(resumePts, videoTimeBase, audioTimeBase)) {
+                av_packet_unref(packet);
+                break;
+            }
+            avcodec_send_packet(audioContext, packet);
+            receiveAudioFrames(audioContext, frame);
+        }
+
+        av_packet_unref(packet);
+        if (resumePts != AV_NOPTS_VALUE && !audioContext) {
+            break;
+        }
+    }
+
+    if (reachedEnd && resumePts == AV_NOPTS_VALUE && !videoFrames.empty()) {
+        // Clip plus court que la limite : il tient entièrement dans le tampon
+        avcodec_send_packet(videoContext, nullptr);
+        receiveVideoFrames(videoContext, frame);
+        resumePts = videoFrames.back()->pts + 1;
+        resumeAtKeyframe = false;
+    }
+
+    if (resumePts != AV_NOPTS_VALUE && audioContext) {
+        // L'audio peut précéder la vidéo dans le fichier : on retire ce qui dépasse le point de reprise
+        int64_t audioResumePts = av_rescale_q(resumePts, videoTimeBase,
+                                              formatContext->streams[audioStreamIndex]->time_base);
+        auto beyond = std::stable_partition(audioFrames.begin(), audioFrames.end(), [&](AVFrame* audioFrame) {
+            return audioFrame->pts == AV_NOPTS_VALUE || audioFrame->pts < audioResumePts;
+        });
+        for (auto it = beyond; it != audioFrames.end(); ++it) {
+            av_frame_free(&*it);
+        }
+        audioFrames.erase(beyond, audioFrames.end());
+    }
+
+    if (isRunning && resumePts != AV_NOPTS_VALUE) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        Logger::logInfo("Loop preroll ready: " + std::to_string(videoFrames.size()) + " video frames (" +
+                        std::to_string(videoBytes / (1024 * 1024)) + " MB), " +
+                        std::to_string(audioFrames.size()) + " audio frames, resuming at " +
+                        (resumeAtKeyframe ? "next keyframe" : "frame after preroll") + ", took " +
+                        std::to_string(static_cast<int>(elapsed.count())) + " ms");
+        ready = true;
+    } else if (isRunning) {
+        Logger::logError("Loop preroll failed, loops will seek to start");
+    }
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&videoContext);
+    avcodec_free_context(&audioContext);
+    avformat_close_input(&formatContext);
+}
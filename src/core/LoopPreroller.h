@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "DecoderConfig.h"
+#include "FrameScaler.h"
+
+extern "C" {
+    #include <libavcodec/avcodec.h>
+    #include <libavformat/avformat.h>
+}
+
+// Décode le début du fichier à l'avance, avec son propre démultiplexeur et ses propres
+// décodeurs, pour que la boucle suivante puisse commencer sans attendre le décodeur principal.
+// Les frames en attente couvrent le premier GOP (ou la limite mémoire/durée) ; le décodeur
+// principal reprend ensuite à getResumePts().
+class LoopPreroller {
+public:
+    LoopPreroller();
+    ~LoopPreroller();
+
+    void start(const std::string& path, const DecoderConfig& config,
+               int videoStreamIndex, int audioStreamIndex);
+    void stop();
+
+    bool isReady() const { return ready; }
+
+    // Valides uniquement lorsque isReady() est vrai ; les frames restent la propriété du preroller
+    const std::vector<AVFrame*>& getVideoFrames() const { return videoFrames; }
+    const std::vector<AVFrame*>& getAudioFrames() const { return audioFrames; }
+    // Première frame vidéo non couverte, en time base du flux vidéo
+    int64_t getResumePts() const { return resumePts; }
+    // Vrai si getResumePts() tombe sur une keyframe : le décodeur principal peut y sauter directement
+    bool resumesAtKeyframe() const { return resumeAtKeyframe; }
+
+private:
+    void prerollThreadFunction(std::string path);
+    AVCodecContext* openDecoder(AVStream* stream);
+    void receiveVideoFrames(AVCodecContext* context, AVFrame* frame);
+    void receiveAudioFrames(AVCodecContext* context, AVFrame* frame);
+    void freeFrames();
+
+    DecoderConfig config;
+    FrameScaler scaler;
+    int videoStreamIndex;
+    int audioStreamIndex;
+    AVRational videoTimeBase;
+
+    std::thread prerollThread;
+    std::atomic<bool> isRunning;
+    std::atomic<bool> ready;
+
+    std::vector<AVFrame*> videoFrames;
+    std::vector<AVFrame*> audioFrames;
+    size_t videoBytes;
+    int64_t firstPts;
+    int64_t resumePts;
+    bool resumeAtKeyframe;
+};
@@ -0,0 +1,87 @@
+#include "NullRenderer.h"
+#include "../utils/Logger.h"
+#include "../utils/Tracer.h"
+#include <cstdio>
+
+NullRenderer::NullRenderer()
+    : started(false)
+    , totalFrames(0)
+    , windowFrames(0)
+    , windowBytes(0)
+    , windowWork(0) {
+}
+
+bool NullRenderer::initialize(int width, int height) {
+    // Taille d'une texture IYUV ; agrandie au besoin si le format ou la taille change
+    texture.resize(static_cast<size_t>(width) * height * 3 / 2);
+    Logger::logInfo("Null renderer: frames are converted and uploaded to memory, presentation is not paced");
+    return true;
+}
+
+void NullRenderer::renderFrame(AVFrame* frame) {
+    if (!frame) return;
+
+    auto start = Clock::now();
+    if (!started) {
+        started = true;
+        firstFrame = start;
+        lastReport = start;
+    }
+
+    // Même disposition que la source, comme un rendu qui accepte IYUV et NV12
+    AVPixelFormat layout = frame->format == AV_PIX_FMT_NV12 ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+    const AVFrame* converted;
+    {
+        TraceScope span("convert", frame->pts);
+        converted = converter.convert(frame, layout);
+    }
+    if (!converted) {
+        return;
+    }
+    {
+        TraceScope span("upload", frame->pts);
+        // Copie vers la texture mémoire, comme l'envoi d'une texture streaming
+        windowBytes += FrameConverter::copyPlanes(converted, texture);
+    }
+
+    auto now = Clock::now();
+    windowWork += now - start;
+    windowFrames++;
+    totalFrames++;
+    report(now);
+}
+
+void NullRenderer::report(Clock::time_point now) {
+    std::chrono::duration<double> elapsed = now - lastReport;
+    if (elapsed < REPORT_INTERVAL || windowFrames == 0) {
+        return;
+    }
+
+    char message[160];
+    snprintf(message, sizeof(message), "Null renderer: %.1f fps, %.2f ms/frame convert+upload, %.1f MB/s uploaded",
+             windowFrames / elapsed.count(), windowWork.count() / windowFrames,
+             windowBytes / (1024.0 * 1024.0) / elapsed.count());
+    Logger::logPerformance(message);
+
+    windowFrames = 0;
+    windowBytes = 0;
+    windowWork = std::chrono::duration<double, std::milli>(0);
+    lastReport = now;
+}
+
+void NullRenderer::cleanup() {
+    if (started && totalFrames > 0) {
+        std::chrono::duration<double> elapsed = Clock::now() - firstFrame;
+        char message[128];
+        snprintf(message, sizeof(message), "Null renderer: %llu frames in %.2f s, %.1f fps average",
+                 static_cast<unsigned long long>(totalFrames), elapsed.count(),
+                 elapsed.count() > 0.0 ? totalFrames / elapsed.count() : 0.0);
+        Logger::logPerformance(message);
+    }
+    started = false;
+    totalFrames = 0;
+
+    converter.release();
+    texture.clear();
+    texture.shrink_to_fit();
+}
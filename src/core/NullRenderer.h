@@ -0,0 +1,38 @@
+#pragma once
+#include "Renderer.h"
+#include "FrameConverter.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Rendu sans écran : chaque frame passe par la même conversion que SdlRenderer puis est
+// copiée dans une texture en mémoire, comme l'envoi vers une texture streaming, sans présentation.
+// Journalise le débit atteint (frames par seconde non plafonnées, coût par frame).
+class NullRenderer : public Renderer {
+public:
+    NullRenderer();
+
+    bool initialize(int width, int height) override;
+    void cleanup() override;
+    void renderFrame(AVFrame* frame) override;
+    RendererBackend backend() const override { return RendererBackend::Null; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void report(Clock::time_point now);
+
+    FrameConverter converter;
+    std::vector<uint8_t> texture;
+
+    // Totaux depuis la première frame, et fenêtre du rapport courant
+    bool started;
+    Clock::time_point firstFrame;
+    uint64_t totalFrames;
+    uint64_t windowFrames;
+    uint64_t windowBytes;
+    std::chrono::duration<double, std::milli> windowWork;
+    Clock::time_point lastReport;
+
+    static constexpr std::chrono::seconds REPORT_INTERVAL{1};
+};
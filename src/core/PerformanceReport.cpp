@@ -0,0 +1,69 @@
+#include "PerformanceReport.h"
+#include "../utils/Logger.h"
+#include <cstdio>
+
+PerformanceReport::PerformanceReport()
+    : presentedFrames(Metrics::counter(Metrics::PRESENTED_FRAMES))
+    , droppedFrames(Metrics::counter(Metrics::DROPPED_FRAMES))
+    , audioUnderruns(Metrics::counter(Metrics::AUDIO_UNDERRUNS))
+    , decodeTime(Metrics::histogram(Metrics::DECODE_TIME_US))
+    , renderTime(Metrics::histogram(Metrics::RENDER_TIME_US))
+    , absoluteDrift(Metrics::histogram(Metrics::AV_DRIFT_US))
+    , queueDepth(Metrics::gauge(Metrics::VIDEO_QUEUE_DEPTH))
+    , audioLatency(Metrics::gauge(Metrics::AUDIO_LATENCY_MS))
+    , drift(Metrics::gauge(Metrics::AV_DRIFT_MS))
+    , lastPresented(presentedFrames.get())
+    , lastDropped(droppedFrames.get())
+    , lastUnderruns(audioUnderruns.get())
+    , lastDecode(decodeTime.snapshot())
+    , lastRender(renderTime.snapshot())
+    , lastDrift(absoluteDrift.snapshot())
+    , lastReport(Clock::now())
+    , interval(DEFAULT_INTERVAL_SECONDS) {
+}
+
+void PerformanceReport::report() {
+    Clock::time_point now = Clock::now();
+    std::chrono::duration<double> elapsed = now - lastReport;
+    if (interval.count() <= 0.0 || elapsed < interval) {
+        return;
+    }
+
+    uint64_t presented = presentedFrames.get();
+    uint64_t dropped = droppedFrames.get();
+    uint64_t underruns = audioUnderruns.get();
+    Histogram::Snapshot decode = decodeTime.snapshot();
+    Histogram::Snapshot render = renderTime.snapshot();
+    Histogram::Snapshot absDrift = absoluteDrift.snapshot();
+    Histogram::Snapshot decodeWindow = decode.since(lastDecode);
+    Histogram::Snapshot renderWindow = render.since(lastRender);
+    Histogram::Snapshot driftWindow = absDrift.since(lastDrift);
+
+    // Premier nombre de chaque ligne : la valeur relevée par le script de comparaison
+    char message[640];
+    snprintf(message, sizeof(message),
+             "Performance summary (%.1f s):\n"
+             "  Average FPS: %.2f\n"
+             "  Frame Processing Time: %.2f ms (p99 %.2f ms)\n"
+             "  Dropped Frames: %llu\n"
+             "  Audio Latency: %.1f ms\n"
+             "  Decode Time: %.2f ms (p99 %.2f ms)\n"
+             "  Video Queue Depth: %.0f frames\n"
+             "  Audio Underruns: %llu\n"
+             "  A/V Drift: %.1f ms (p99 %.1f ms absolute)",
+             elapsed.count(), (presented - lastPresented) / elapsed.count(),
+             renderWindow.mean() / 1000.0, renderWindow.percentile(0.99) / 1000.0,
+             static_cast<unsigned long long>(dropped - lastDropped), audioLatency.get(),
+             decodeWindow.mean() / 1000.0, decodeWindow.percentile(0.99) / 1000.0, queueDepth.get(),
+             static_cast<unsigned long long>(underruns - lastUnderruns), drift.get(),
+             driftWindow.percentile(0.99) / 1000.0);
+    Logger::logPerformance(message);
+
+    lastPresented = presented;
+    lastDropped = dropped;
+    lastUnderruns = underruns;
+    lastDecode = decode;
+    lastRender = render;
+    lastDrift = absDrift;
+    lastReport = now;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "../utils/Metrics.h"
+#include <chrono>
+#include <cstdint>
+
+// Résumé périodique des métriques du lecteur, journalisé par Logger::logPerformance dans le
+// format lu par scripts/compare_performance.py (une métrique par ligne, "Nom: valeur").
+// Les valeurs couvrent l'intervalle écoulé depuis le résumé précédent.
+// Utilisé uniquement par le thread principal.
+class PerformanceReport {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PerformanceReport();
+
+    // 0 : désactivé
+    void setInterval(double seconds) { interval = std::chrono::duration<double>(seconds); }
+    // À appeler régulièrement ; ne journalise qu'une fois l'intervalle écoulé
+    void report();
+
+private:
+    Counter& presentedFrames;
+    Counter& droppedFrames;
+    Counter& audioUnderruns;
+    Histogram& decodeTime;
+    Histogram& renderTime;
+    Histogram& absoluteDrift;
+    Gauge& queueDepth;
+    Gauge& audioLatency;
+    Gauge& drift;
+
+    // Valeurs au résumé précédent
+    uint64_t lastPresented;
+    uint64_t lastDropped;
+    uint64_t lastUnderruns;
+    Histogram::Snapshot lastDecode;
+    Histogram::Snapshot lastRender;
+    Histogram::Snapshot lastDrift;
+    Clock::time_point lastReport;
+    std::chrono::duration<double> interval;
+
+    static constexpr double DEFAULT_INTERVAL_SECONDS = 5.0;
+};
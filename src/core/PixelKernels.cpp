@@ -0,0 +1,380 @@
+#include "PixelKernels.h"
+#include <initializer_list>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define PIXEL_KERNELS_SSE2 1
+#if defined(__GNUC__)
+#define PIXEL_KERNELS_AVX2 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PIXEL_KERNELS_NEON 1
+#endif
+
+// Compression : ((x * k + 32768) >> 16) + 16, k = 219/255 (luma) ou 224/255 (chroma) en
+// virgule fixe /65536 ; arrondi exact de x * 219/255 ou x * 224/255 pour tout x de 0 à 255
+// (chroma : 0 -> 16, 128 -> 128, 255 -> 240 ; luma : 255 -> 235)
+// Expansion en virgule fixe /256 : d + ((d * e + 128) >> 8) autour de 16 (luma, e = 42) ou 128 (chroma, e = 36)
+static constexpr int LUMA_COMPRESS = 56284;
+static constexpr int CHROMA_COMPRESS = 57569;
+static constexpr int LUMA_EXPAND = 42;
+static constexpr int CHROMA_EXPAND = 36;
+
+static inline uint8_t clampByte(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// --- Référence scalaire, utilisée aussi pour la fin des lignes ---
+
+static void downshift10Scalar(const uint16_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = clampByte((src[i] + 2) >> 2);
+    }
+}
+
+static void deinterleaveScalar(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t pairs) {
+    for (size_t i = 0; i < pairs; i++) {
+        u[i] = uv[2 * i];
+        v[i] = uv[2 * i + 1];
+    }
+}
+
+static void interleaveScalar(const uint8_t* u, const uint8_t* v, uint8_t* uv, size_t pairs) {
+    for (size_t i = 0; i < pairs; i++) {
+        uv[2 * i] = u[i];
+        uv[2 * i + 1] = v[i];
+    }
+}
+
+static void fullToLimitedScalar(const uint8_t* src, uint8_t* dst, size_t count, bool chroma) {
+    uint32_t scale = chroma ? CHROMA_COMPRESS : LUMA_COMPRESS;
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = static_cast<uint8_t>(((src[i] * scale + 32768) >> 16) + 16);
+    }
+}
+
+static void limitedToFullScalar(const uint8_t* src, uint8_t* dst, size_t count, bool chroma) {
+    int center = chroma ? 128 : 16;
+    int base = chroma ? 128 : 0;
+    int extra = chroma ? CHROMA_EXPAND : LUMA_EXPAND;
+    for (size_t i = 0; i < count; i++) {
+        int d = src[i] - center;
+        dst[i] = clampByte(base + d + ((d * extra + 128) >> 8));
+    }
+}
+
+#if defined(PIXEL_KERNELS_SSE2)
+
+static void downshift10SSE2(const uint16_t* src, uint8_t* dst, size_t count) {
+    const __m128i rounding = _mm_set1_epi16(2);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        low = _mm_srli_epi16(_mm_adds_epu16(low, rounding), 2);
+        high = _mm_srli_epi16(_mm_adds_epu16(high, rounding), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+    }
+    downshift10Scalar(src + i, dst + i, count - i);
+}
+
+static void deinterleaveSSE2(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t pairs) {
+    const __m128i evenMask = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+    for (; i + 16 <= pairs; i += 16) {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + 2 * i));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + 2 * i + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(u + i),
+                         _mm_packus_epi16(_mm_and_si128(first, evenMask), _mm_and_si128(second, evenMask)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i),
+                         _mm_packus_epi16(_mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8)));
+    }
+    deinterleaveScalar(uv + 2 * i, u + i, v + i, pairs - i);
+}
+
+static void interleaveSSE2(const uint8_t* u, const uint8_t* v, uint8_t* uv, size_t pairs) {
+    size_t i = 0;
+    for (; i + 16 <= pairs; i += 16) {
+        __m128i us = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i));
+        __m128i vs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + 2 * i), _mm_unpacklo_epi8(us, vs));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + 2 * i + 16), _mm_unpackhi_epi8(us, vs));
+    }
+    interleaveScalar(u + i, v + i, uv + 2 * i, pairs - i);
+}
+
+// Pixels placés dans l'octet haut : mulhi donne (x * k) >> 8, et ((y + 128) >> 8) vaut
+// exactement ((x * k + 32768) >> 16) ; y + 128 reste sous 65536
+static inline __m128i compressSSE2(__m128i shifted, __m128i scale, __m128i rounding, __m128i offset) {
+    return _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(_mm_mulhi_epu16(shifted, scale), rounding), 8), offset);
+}
+
+static void fullToLimitedSSE2(const uint8_t* src, uint8_t* dst, size_t count, bool chroma) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i scale = _mm_set1_epi16(static_cast<int16_t>(chroma ? CHROMA_COMPRESS : LUMA_COMPRESS));
+    const __m128i rounding = _mm_set1_epi16(128);
+    const __m128i offset = _mm_set1_epi16(16);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i low = _mm_unpacklo_epi8(zero, pixels);
+        __m128i high = _mm_unpackhi_epi8(zero, pixels);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_packus_epi16(compressSSE2(low, scale, rounding, offset),
+                                          compressSSE2(high, scale, rounding, offset)));
+    }
+    fullToLimitedScalar(src + i, dst + i, count - i, chroma);
+}
+
+static inline __m128i expandSSE2(__m128i d, __m128i extra, __m128i rounding, __m128i base) {
+    __m128i scaled = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(d, extra), rounding), 8);
+    return _mm_add_epi16(_mm_add_epi16(d, scaled), base);
+}
+
+static void limitedToFullSSE2(const uint8_t* src, uint8_t* dst, size_t count, bool chroma) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i center = _mm_set1_epi16(chroma ? 128 : 16);
+    const __m128i base = _mm_set1_epi16(chroma ? 128 : 0);
+    const __m128i extra = _mm_set1_epi16(chroma ? CHROMA_EXPAND : LUMA_EXPAND);
+    const __m128i rounding = _mm_set1_epi16(128);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i low = _mm_sub_epi16(_mm_unpacklo_epi8(pixels, zero), center);
+        __m128i high = _mm_sub_epi16(_mm_unpackhi_epi8(pixels, zero), center);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_packus_epi16(expandSSE2(low, extra, rounding, base),
+                                          expandSSE2(high, extra, rounding, base)));
+    }
+    limitedToFullScalar(src + i, dst + i, count - i, chroma);
+}
+
+#endif
+
+#if defined(PIXEL_KERNELS_AVX2)
+
+// pack et unpack travaillent par moitié de 128 bits : les permutations remettent les octets dans l'ordre
+
+AVX2_TARGET static void downshift10AVX2(const uint16_t* src, uint8_t* dst, size_t count) {
+    const __m256i rounding = _mm256_set1_epi16(2);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16));
+        low = _mm256_srli_epi16(_mm256_adds_epu16(low, rounding), 2);
+        high = _mm256_srli_epi16(_mm256_adds_epu16(high, rounding), 2);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    downshift10SSE2(src + i, dst + i, count - i);
+}
+
+AVX2_TARGET static void deinterleaveAVX2(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t pairs) {
+    const __m256i evenMask = _mm256_set1_epi16(0x00FF);
+    size_t i = 0;
+    for (; i + 32 <= pairs; i += 32) {
+        __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(uv + 2 * i));
+        __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(uv + 2 * i + 32));
+        __m256i us = _mm256_packus_epi16(_mm256_and_si256(first, evenMask), _mm256_and_si256(second, evenMask));
+        __m256i vs = _mm256_packus_epi16(_mm256_srli_epi16(first, 8), _mm256_srli_epi16(second, 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(u + i), _mm256_permute4x64_epi64(us, _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + i), _mm256_permute4x64_epi64(vs, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    deinterleaveSSE2(uv + 2 * i, u + i, v + i, pairs - i);
+}
+
+AVX2_TARGET static void interleaveAVX2(const uint8_t* u, const uint8_t* v, uint8_t* uv, size_t pairs) {
+    size_t i = 0;
+    for (; i + 32 <= pairs; i += 32) {
+        __m256i us = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + i));
+        __m256i vs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+        __m256i low = _mm256_unpacklo_epi8(us, vs);
+        __m256i high = _mm256_unpackhi_epi8(us, vs);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(uv + 2 * i), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(uv + 2 * i + 32), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    interleaveSSE2(u + i, v + i, uv + 2 * i, pairs - i);
+}
+
+AVX2_TARGET static void fullToLimitedAVX2(const uint8_t* src, uint8_t* dst, size_t count, bool chroma) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i scale = _mm256_set1_epi16(static_cast<int16_t>(chroma ? CHROMA_COMPRESS : LUMA_COMPRESS));
+    const __m256i rounding = _mm256_set1_epi16(128);
+    const __m256i offset = _mm256_set1_epi16(16);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        // Même calcul que compressSSE2
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i low = _mm256_unpacklo_epi8(zero, pixels);
+        __m256i high = _mm256_unpackhi_epi8(zero, pixels);
+        low = _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(_mm256_mulhi_epu16(low, scale), rounding), 8), offset);
+        high = _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(_mm256_mulhi_epu16(high, scale), rounding), 8), offset);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(low, high));
+    }
+    fullToLimitedSSE2(src + i, dst + i, count - i, chroma);
+}
+
+AVX2_TARGET static void limitedToFullAVX2(const uint8_t* src, uint8_t* dst, size_t count, bool chroma) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i center = _mm256_set1_epi16(chroma ? 128 : 16);
+    const __m256i base = _mm256_set1_epi16(chroma ? 128 : 0);
+    const __m256i extra = _mm256_set1_epi16(chroma ? CHROMA_EXPAND : LUMA_EXPAND);
+    const __m256i rounding = _mm256_set1_epi16(128);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i halves[2] = {_mm256_sub_epi16(_mm256_unpacklo_epi8(pixels, zero), center),
+                             _mm256_sub_epi16(_mm256_unpackhi_epi8(pixels, zero), center)};
+        for (__m256i& d : halves) {
+            __m256i scaled = _mm256_srai_epi16(_mm256_add_epi16(_mm256_mullo_epi16(d, extra), rounding), 8);
+            d = _mm256_add_epi16(_mm256_add_epi16(d, scaled), base);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(halves[0], halves[1]));
+    }
+    limitedToFullSSE2(src + i, dst + i, count - i, chroma);
+}
+
+#endif
+
+#if defined(PIXEL_KERNELS_NEON)
+
+static void downshift10NEON(const uint16_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // vrshrq : (x + 2) >> 2 calculé sans débordement, puis réduction saturée à 255
+        uint8x8_t low = vqmovn_u16(vrshrq_n_u16(vld1q_u16(src + i), 2));
+        uint8x8_t high = vqmovn_u16(vrshrq_n_u16(vld1q_u16(src + i + 8), 2));
+        vst1q_u8(dst + i, vcombine_u8(low, high));
+    }
+    downshift10Scalar(src + i, dst + i, count - i);
+}
+
+static void deinterleaveNEON(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t pairs) {
+    size_t i = 0;
+    for (; i + 16 <= pairs; i += 16) {
+        uint8x16x2_t planes = vld2q_u8(uv + 2 * i);
+        vst1q_u8(u + i, planes.val[0]);
+        vst1q_u8(v + i, planes.val[1]);
+    }
+    deinterleaveScalar(uv + 2 * i, u + i, v + i, pairs - i);
+}
+
+static void interleaveNEON(const uint8_t* u, const uint8_t* v, uint8_t* uv, size_t pairs) {
+    size_t i = 0;
+    for (; i + 16 <= pairs; i += 16) {
+        uint8x16x2_t planes;
+        planes.val[0] = vld1q_u8(u + i);
+        planes.val[1] = vld1q_u8(v + i);
+        vst2q_u8(uv + 2 * i, planes);
+    }
+    interleaveScalar(u + i, v + i, uv + 2 * i, pairs - i);
+}
+
+// vrshrn : (x * k + 32768) >> 16 sur les produits 32 bits, réduit à 16 bits
+static inline uint8x8_t compressNEON(uint8x8_t pixels, uint16_t scale) {
+    uint16x8_t wide = vmovl_u8(pixels);
+    uint16x4_t low = vrshrn_n_u32(vmull_n_u16(vget_low_u16(wide), scale), 16);
+    uint16x4_t high = vrshrn_n_u32(vmull_n_u16(vget_high_u16(wide), scale), 16);
+    return vmovn_u16(vcombine_u16(low, high));
+}
+
+static void fullToLimitedNEON(const uint8_t* src, uint8_t* dst, size_t count, bool chroma) {
+    const uint16_t scale = chroma ? CHROMA_COMPRESS : LUMA_COMPRESS;
+    const uint8x16_t offset = vdupq_n_u8(16);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t pixels = vld1q_u8(src + i);
+        uint8x16_t scaled = vcombine_u8(compressNEON(vget_low_u8(pixels), scale),
+                                        compressNEON(vget_high_u8(pixels), scale));
+        vst1q_u8(dst + i, vaddq_u8(scaled, offset));
+    }
+    fullToLimitedScalar(src + i, dst + i, count - i, chroma);
+}
+
+static inline uint8x8_t expandNEON(uint8x8_t pixels, int16x8_t center, int16_t extra, int16x8_t base) {
+    int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(pixels)), center);
+    int16x8_t scaled = vrshrq_n_s16(vmulq_n_s16(d, extra), 8);
+    return vqmovun_s16(vaddq_s16(vaddq_s16(d, scaled), base));
+}
+
+static void limitedToFullNEON(const uint8_t* src, uint8_t* dst, size_t count, bool chroma) {
+    const int16x8_t center = vdupq_n_s16(chroma ? 128 : 16);
+    const int16x8_t base = vdupq_n_s16(chroma ? 128 : 0);
+    const int16_t extra = chroma ? CHROMA_EXPAND : LUMA_EXPAND;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t pixels = vld1q_u8(src + i);
+        vst1q_u8(dst + i, vcombine_u8(expandNEON(vget_low_u8(pixels), center, extra, base),
+                                      expandNEON(vget_high_u8(pixels), center, extra, base)));
+    }
+    limitedToFullScalar(src + i, dst + i, count - i, chroma);
+}
+
+#endif
+
+bool PixelKernels::isSupported(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#if defined(PIXEL_KERNELS_SSE2)
+        case Isa::SSE2:
+            return true;
+#endif
+#if defined(PIXEL_KERNELS_AVX2)
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+#if defined(PIXEL_KERNELS_NEON)
+        case Isa::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+PixelKernels::Table PixelKernels::forIsa(Isa isa) {
+    if (!isSupported(isa)) {
+        isa = Isa::Scalar;
+    }
+    switch (isa) {
+#if defined(PIXEL_KERNELS_SSE2)
+        case Isa::SSE2:
+            return {isa, downshift10SSE2, deinterleaveSSE2, interleaveSSE2, fullToLimitedSSE2, limitedToFullSSE2};
+#endif
+#if defined(PIXEL_KERNELS_AVX2)
+        case Isa::AVX2:
+            return {isa, downshift10AVX2, deinterleaveAVX2, interleaveAVX2, fullToLimitedAVX2, limitedToFullAVX2};
+#endif
+#if defined(PIXEL_KERNELS_NEON)
+        case Isa::NEON:
+            return {isa, downshift10NEON, deinterleaveNEON, interleaveNEON, fullToLimitedNEON, limitedToFullNEON};
+#endif
+        default:
+            return {Isa::Scalar, downshift10Scalar, deinterleaveScalar, interleaveScalar,
+                    fullToLimitedScalar, limitedToFullScalar};
+    }
+}
+
+const PixelKernels::Table& PixelKernels::best() {
+    static const Table table = []() {
+        for (Isa isa : {Isa::AVX2, Isa::NEON, Isa::SSE2}) {
+            if (isSupported(isa)) {
+                return forIsa(isa);
+            }
+        }
+        return forIsa(Isa::Scalar);
+    }();
+    return table;
+}
+
+const char* PixelKernels::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+        case Isa::NEON: return "neon";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Noyaux de conversion de format de pixels, par ligne, vectorisés (NEON, SSE2, AVX2)
+// avec une version scalaire de référence. Toutes les variantes produisent exactement
+// le même résultat que la version scalaire ; la variante est choisie une fois au lancement.
+class PixelKernels {
+public:
+    enum class Isa {
+        Scalar,
+        SSE2,
+        AVX2,
+        NEON
+    };
+
+    // yuv420p10le vers 8 bits : (x + 2) >> 2, saturé à 255
+    using Downshift10 = void (*)(const uint16_t* src, uint8_t* dst, size_t count);
+    // Plan UV entrelacé (nv12) vers plans U et V séparés (i420), et inversement
+    using Deinterleave = void (*)(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t pairs);
+    using Interleave = void (*)(const uint8_t* u, const uint8_t* v, uint8_t* uv, size_t pairs);
+    // Plage complète (0-255) vers plage limitée (16-235 / 16-240), et inversement
+    using RangeConvert = void (*)(const uint8_t* src, uint8_t* dst, size_t count, bool chroma);
+
+    struct Table {
+        Isa isa;
+        Downshift10 downshift10;
+        Deinterleave deinterleave;
+        Interleave interleave;
+        RangeConvert fullToLimited;
+        RangeConvert limitedToFull;
+    };
+
+    // Meilleure variante prise en charge par le processeur, détectée au premier appel
+    static const Table& best();
+    // Variante donnée ; retombe sur le scalaire si elle n'est pas compilée ou pas prise en charge
+    static Table forIsa(Isa isa);
+    static bool isSupported(Isa isa);
+    static const char* isaName(Isa isa);
+};
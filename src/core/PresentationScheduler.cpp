@@ -0,0 +1,155 @@
+#include "PresentationScheduler.h"
+#include "AudioManager.h"
+#include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+static double seconds(PresentationScheduler::Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+static std::string formatMs(double seconds) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.1f", seconds * 1000.0);
+    return buffer;
+}
+
+PresentationScheduler::PresentationScheduler()
+    : audioManager(nullptr)
+    , frameDuration(1.0 / 30.0)
+    , master(Master::Monotonic)
+    , anchored(false)
+    , anchorPts(0.0)
+    , audioLocked(false)
+    , presentedFrames(0)
+    , droppedFrames(0)
+    , repeatedFrames(0)
+    , gapTracked(false)
+    , lastReport(Clock::now())
+    , lastMeanError(0.0)
+    , lastP99Error(0.0)
+    , lastMaxError(0.0) {
+}
+
+void PresentationScheduler::reset() {
+    anchored = false;
+    audioLocked = false;
+    gapTracked = false;
+}
+
+const char* PresentationScheduler::masterName(Master master) {
+    return master == Master::Audio ? "audio" : "monotonic";
+}
+
+void PresentationScheduler::setMaster(Master newMaster) {
+    if (master != newMaster) {
+        master = newMaster;
+        Logger::logInfo(std::string("Sync master clock: ") + masterName(master));
+    }
+}
+
+void PresentationScheduler::anchorMonotonic(double pts, Clock::time_point now) {
+    anchored = true;
+    anchorTime = now;
+    anchorPts = pts;
+}
+
+double PresentationScheduler::masterClock(Clock::time_point now, double pts) {
+    bool audioPlaying = false;
+    double audioClock = 0.0;
+    if (audioManager && audioManager->isInitialized()) {
+        // Déjà compensée de la latence du périphérique et interpolée entre deux callbacks
+        AudioManager::ClockReading reading = audioManager->readClock(now);
+        audioPlaying = reading.running;
+        audioClock = reading.pts;
+    }
+
+    if (audioLocked && !audioPlaying) {
+        // L'audio s'est arrêté : l'horloge monotone continue depuis sa dernière valeur
+        audioLocked = false;
+        anchorMonotonic(audioClock, now);
+        setMaster(Master::Monotonic);
+    } else if (!audioLocked && audioPlaying && std::fabs(audioClock - pts) < AUDIO_LOCK_WINDOW) {
+        // Après un seek, l'audio rejoue encore l'ancienne position tant que sa file n'est pas vidée
+        audioLocked = true;
+        setMaster(Master::Audio);
+    }
+
+    if (audioLocked) {
+        return audioClock;
+    }
+    return anchorPts + seconds(now - anchorTime);
+}
+
+double PresentationScheduler::timeUntilDue(double pts) {
+    Clock::time_point now = Clock::now();
+    if (!anchored) {
+        anchorMonotonic(pts, now);
+    }
+    double delay = pts - masterClock(now, pts);
+    if (!audioLocked && delay < -MAX_MONOTONIC_LAG) {
+        anchorMonotonic(pts, now);
+        delay = 0.0;
+    }
+    return delay;
+}
+
+void PresentationScheduler::recordPresent(double pts) {
+    static Gauge& drift = Metrics::gauge(Metrics::AV_DRIFT_MS);
+    static Histogram& absoluteDrift = Metrics::histogram(Metrics::AV_DRIFT_US);
+    Clock::time_point now = Clock::now();
+    double error = masterClock(now, pts) - pts;
+    errors.push_back(error);
+    drift.set(error * 1000.0);
+    absoluteDrift.record(static_cast<uint64_t>(std::fabs(error) * 1e6));
+    presentedFrames++;
+
+    // Frame restée affichée plus longtemps que sa durée : la vidéo attendait l'horloge
+    if (gapTracked && frameDuration > 0.0) {
+        long extra = std::lround(seconds(now - lastPresent) / frameDuration) - 1;
+        if (extra > 0) {
+            repeatedFrames += extra;
+        }
+    }
+    gapTracked = true;
+    lastPresent = now;
+}
+
+void PresentationScheduler::recordDrop() {
+    droppedFrames++;
+    gapTracked = false;
+}
+
+PresentationScheduler::Stats PresentationScheduler::getStats() const {
+    return {master, presentedFrames, droppedFrames, repeatedFrames,
+            lastMeanError * 1000.0, lastP99Error * 1000.0, lastMaxError * 1000.0};
+}
+
+void PresentationScheduler::report() {
+    Clock::time_point now = Clock::now();
+    if (now - lastReport < std::chrono::seconds(1) || errors.empty()) {
+        return;
+    }
+
+    double sum = 0.0;
+    for (double& error : errors) {
+        sum += error;
+        error = std::fabs(error);
+    }
+    lastMeanError = sum / errors.size();
+    size_t p99 = std::min(errors.size() - 1, errors.size() * 99 / 100);
+    std::nth_element(errors.begin(), errors.begin() + p99, errors.end());
+    lastP99Error = errors[p99];
+    lastMaxError = *std::max_element(errors.begin(), errors.end());
+
+    Logger::logPerformance(std::string("A/V sync (") + masterName(master) + " master): error mean " +
+                           formatMs(lastMeanError) + " ms, p99 " + formatMs(lastP99Error) +
+                           " ms, max " + formatMs(lastMaxError) + " ms | presented " +
+                           std::to_string(presentedFrames) + ", dropped " + std::to_string(droppedFrames) +
+                           ", repeated " + std::to_string(repeatedFrames));
+    errors.clear();
+    lastReport = now;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class AudioManager;
+
+// Cadence la présentation des frames vidéo sur une horloge maître : l'horloge audio
+// lorsque l'audio joue et s'est recalé sur la vidéo, sinon une horloge monotone ancrée
+// sur la première frame présentée. L'écart de synchronisation est mesuré à chaque présentation.
+// Utilisé uniquement par le thread de rendu.
+class PresentationScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Master {
+        Audio,
+        Monotonic
+    };
+
+    struct Stats {
+        Master master;
+        uint64_t presentedFrames;
+        uint64_t droppedFrames;
+        uint64_t repeatedFrames;   // durées de frame supplémentaires pendant lesquelles une frame est restée affichée
+        double meanErrorMs;        // moyenne signée de (horloge maître - PTS) sur la dernière fenêtre
+        double p99ErrorMs;         // en valeur absolue
+        double maxErrorMs;
+    };
+
+    PresentationScheduler();
+
+    // nullptr ou audio non initialisé : horloge monotone uniquement
+    void setAudioManager(const AudioManager* audio) { audioManager = audio; }
+    void setFrameDuration(double seconds) { frameDuration = seconds; }
+
+    // Discontinuité (seek) ou pause : l'horloge monotone se réancre sur la frame suivante,
+    // l'horloge audio n'est reprise qu'une fois revenue près des PTS vidéo
+    void reset();
+    // Temps restant avant l'échéance de la frame, en secondes (négatif : en retard)
+    double timeUntilDue(double pts);
+    void recordPresent(double pts);
+    void recordDrop();
+
+    Stats getStats() const;
+    static const char* masterName(Master master);
+    // Journalise l'écart de synchronisation une fois par seconde
+    void report();
+
+private:
+    // pts : frame en cours, sert à décider si l'horloge audio est assez proche pour être reprise
+    double masterClock(Clock::time_point now, double pts);
+    void setMaster(Master newMaster);
+    void anchorMonotonic(double pts, Clock::time_point now);
+
+    const AudioManager* audioManager;
+    double frameDuration;
+    Master master;
+
+    // Horloge monotone : anchorPts à anchorTime
+    bool anchored;
+    Clock::time_point anchorTime;
+    double anchorPts;
+
+    bool audioLocked;
+
+    uint64_t presentedFrames;
+    uint64_t droppedFrames;
+    uint64_t repeatedFrames;
+    // Faux après une perte, une pause ou un seek : l'écart suivant n'est pas une répétition
+    bool gapTracked;
+    Clock::time_point lastPresent;
+
+    // Écarts de la fenêtre de rapport courante, en secondes
+    std::vector<double> errors;
+    Clock::time_point lastReport;
+    double lastMeanError;
+    double lastP99Error;
+    double lastMaxError;
+
+    // Écart maximal pour (re)prendre l'audio comme maître, en secondes
+    static constexpr double AUDIO_LOCK_WINDOW = 0.5;
+    // Sans audio, un retard plus grand n'est pas rattrapé : l'horloge monotone se réancre
+    static constexpr double MAX_MONOTONIC_LAG = 0.5;
+};
@@ -1,29 +1,45 @@
 #pragma once
-#include <SDL2/SDL.h>
+#include <memory>
 #include <string>
 
 extern "C" {
-    #include <libavcodec/avcodec.h>
-    #include <libswscale/swscale.h>
-    #include <libavutil/pixfmt.h>
+    #include <libavutil/frame.h>
 }
 
+enum class RendererBackend {
+    Sdl,   // fenêtre KMSDRM, présentation cadencée sur les PTS
+    Null   // conversion et envoi vers la mémoire, sans présentation ni cadence : mesure du débit
+};
+
+enum class TextureUpload {
+    Ring,    // anneau de textures verrouillées, écrites par un thread de conversion pendant l'affichage
+    Update   // une texture mise à jour par SDL_UpdateYUVTexture au moment de la présentation
+};
+
+struct RendererOptions {
+    int displayIndex = 0;  // écran qui reçoit la fenêtre plein écran
+    TextureUpload textureUpload = TextureUpload::Ring;
+};
+
+// Backend de rendu, créé puis utilisé uniquement par le thread de rendu
 class Renderer {
 public:
-    Renderer();
-    ~Renderer();
+    virtual ~Renderer() = default;
+
+    virtual bool initialize(int width, int height) = 0;
+    virtual void cleanup() = 0;
+    // Frame suivante connue avant son échéance : le backend peut commencer à l'envoyer.
+    // La frame reste à l'appelant ; renderFrame() suit avec la même frame, ou une autre si elle est jetée
+    virtual void prepareFrame(const AVFrame* frame) {}
+    // La frame préparée est jetée sans être rendue : l'appelant va la libérer, et son adresse
+    // peut être réutilisée par une frame suivante
+    virtual void abandonPrepared() {}
+    virtual void renderFrame(AVFrame* frame) = 0;
+    virtual RendererBackend backend() const = 0;
 
-    bool initialize(int width, int height);
-    void cleanup();
-    void renderFrame(AVFrame* frame);
-    
-private:
-    SDL_Window* window;
-    SDL_Renderer* renderer;
-    SDL_Texture* texture;
-    SwsContext* swsContext;
-    
-    uint8_t* yPlane;
-    uint8_t* uPlane;
-    uint8_t* vPlane;
-}; 
\ No newline at end of file
+    static std::unique_ptr<Renderer> create(RendererBackend backend, const RendererOptions& options);
+    static const char* backendName(RendererBackend backend);
+    static bool parseBackend(const std::string& name, RendererBackend& backend);
+    static const char* textureUploadName(TextureUpload upload);
+    static bool parseTextureUpload(const std::string& name, TextureUpload& upload);
+};
@@ -0,0 +1,407 @@
+#include "SdlRenderer.h"
+#include "PixelKernels.h"
+#include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/Tracer.h"
+
+SdlRenderer::SdlRenderer(const RendererOptions& options)
+    : options(options)
+    , window(nullptr)
+    , renderer(nullptr)
+    , textureFormat(SDL_PIXELFORMAT_UNKNOWN)
+    , textureWidth(0)
+    , textureHeight(0)
+    , displayedSlot(-1)
+    , iyuvSupported(true)
+    , nv12Supported(false)
+    , preparedSource(nullptr)
+    , preparedFrame(nullptr)
+    , preparedLayout(AV_PIX_FMT_NONE)
+    , preparedSlot(-1)
+    , writePending(false)
+    , writeSucceeded(false)
+    , converterStopping(false)
+    , windowFrames(0)
+    , windowPreparedAhead(0)
+    , windowUpload(0)
+    , windowWrite(0) {
+}
+
+SdlRenderer::~SdlRenderer() {
+    cleanup();
+}
+
+bool SdlRenderer::initialize(int width, int height) {
+    // Force KMSDRM driver for hardware acceleration
+    if (!SDL_SetHint(SDL_HINT_RENDER_DRIVER, "KMSDRM")) {
+        Logger::logError("Failed to set KMSDRM hint");
+    }
+    if (!SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1")) {
+        Logger::logError("Failed to set VSYNC hint");
+    }
+    if (!SDL_SetHint(SDL_HINT_VIDEO_DOUBLE_BUFFER, "1")) {
+        Logger::logError("Failed to set double buffer hint");
+    }
+
+    window = SDL_CreateWindow(
+        "Video Player",
+        SDL_WINDOWPOS_UNDEFINED_DISPLAY(options.displayIndex),
+        SDL_WINDOWPOS_UNDEFINED_DISPLAY(options.displayIndex),
+        1920, 1080,
+        SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN_DESKTOP
+    );
+
+    if (!window) {
+        Logger::logError("Window creation failed: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    renderer = SDL_CreateRenderer(window, -1, 
+        SDL_RENDERER_ACCELERATED | 
+        SDL_RENDERER_PRESENTVSYNC | 
+        SDL_RENDERER_TARGETTEXTURE
+    );
+
+    if (!renderer) {
+        Logger::logError("Renderer creation failed: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    // Sans liste de formats, IYUV reste la valeur sûre ; le NV12 n'est gardé que s'il est annoncé
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) == 0) {
+        iyuvSupported = false;
+        nv12Supported = false;
+        for (Uint32 i = 0; i < info.num_texture_formats; i++) {
+            iyuvSupported |= info.texture_formats[i] == SDL_PIXELFORMAT_IYUV;
+            nv12Supported |= info.texture_formats[i] == SDL_PIXELFORMAT_NV12;
+        }
+    }
+    Logger::logInfo(std::string("Renderer texture formats: IYUV ") + (iyuvSupported ? "yes" : "no") +
+                    ", NV12 " + (nv12Supported ? "yes" : "no") +
+                    ", conversion kernels " + PixelKernels::isaName(PixelKernels::best().isa));
+
+    // Textures IYUV par défaut ; recréées au premier frame si le décodeur sort du NV12
+    if (!ensureTextures(SDL_PIXELFORMAT_IYUV, width, height)) {
+        return false;
+    }
+
+    SDL_RenderSetLogicalSize(renderer, width, height);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+
+    if (options.textureUpload == TextureUpload::Ring) {
+        converterThread = std::thread(&SdlRenderer::converterThreadFunction, this);
+        Logger::logInfo("Texture upload: ring of " + std::to_string(RING_SIZE) +
+                        " streaming textures written by a converter thread");
+    } else {
+        Logger::logInfo("Texture upload: single streaming texture updated at present time");
+    }
+    lastReport = Clock::now();
+
+    return true;
+}
+
+AVPixelFormat SdlRenderer::textureLayoutFor(int pixelFormat) const {
+    if (pixelFormat == AV_PIX_FMT_NV12) {
+        return nv12Supported || !iyuvSupported ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+    }
+    return iyuvSupported || !nv12Supported ? AV_PIX_FMT_YUV420P : AV_PIX_FMT_NV12;
+}
+
+bool SdlRenderer::ensureTextures(Uint32 format, int width, int height) {
+    if (!slots.empty() && textureFormat == format && textureWidth == width && textureHeight == height) {
+        return true;
+    }
+
+    destroyTextures();
+    int count = options.textureUpload == TextureUpload::Ring ? RING_SIZE : 1;
+    for (int i = 0; i < count; i++) {
+        SDL_Texture* texture = SDL_CreateTexture(
+            renderer,
+            format,
+            SDL_TEXTUREACCESS_STREAMING,
+            width,
+            height
+        );
+
+        if (!texture) {
+            Logger::logError("Texture creation failed: " + std::string(SDL_GetError()));
+            destroyTextures();
+            return false;
+        }
+        slots.push_back(TextureSlot{texture, false, {nullptr, nullptr, nullptr}, {0, 0, 0}});
+    }
+
+    textureFormat = format;
+    textureWidth = width;
+    textureHeight = height;
+    return true;
+}
+
+void SdlRenderer::destroyTextures() {
+    for (TextureSlot& slot : slots) {
+        if (slot.locked) {
+            SDL_UnlockTexture(slot.texture);
+        }
+        SDL_DestroyTexture(slot.texture);
+    }
+    slots.clear();
+    textureFormat = SDL_PIXELFORMAT_UNKNOWN;
+    displayedSlot = -1;
+}
+
+bool SdlRenderer::lockSlot(TextureSlot& slot) {
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(slot.texture, nullptr, &pixels, &pitch) != 0) {
+        Logger::logError("Texture lock failed: " + std::string(SDL_GetError()));
+        return false;
+    }
+    slot.locked = true;
+
+    // Plans contigus, disposés comme SDL le fait pour ses textures YUV :
+    // Y, puis U et V (IYUV) ou UV entrelacé (NV12)
+    uint8_t* base = static_cast<uint8_t*>(pixels);
+    slot.planes[0] = base;
+    slot.pitches[0] = pitch;
+    slot.planes[1] = base + static_cast<size_t>(pitch) * textureHeight;
+    if (textureFormat == SDL_PIXELFORMAT_NV12) {
+        slot.pitches[1] = 2 * ((pitch + 1) / 2);
+        slot.planes[2] = nullptr;
+        slot.pitches[2] = 0;
+    } else {
+        slot.pitches[1] = (pitch + 1) / 2;
+        slot.planes[2] = slot.planes[1] + static_cast<size_t>(slot.pitches[1]) * ((textureHeight + 1) / 2);
+        slot.pitches[2] = slot.pitches[1];
+    }
+    return true;
+}
+
+void SdlRenderer::prepareFrame(const AVFrame* frame) {
+    if (options.textureUpload != TextureUpload::Ring || !frame || !renderer || preparedSource == frame) {
+        return;
+    }
+    abandonPrepared();
+
+    AVPixelFormat layout = textureLayoutFor(frame->format);
+    Uint32 format = layout == AV_PIX_FMT_NV12 ? SDL_PIXELFORMAT_NV12 : SDL_PIXELFORMAT_IYUV;
+    if (!ensureTextures(format, frame->width, frame->height)) {
+        return;
+    }
+
+    // Texture suivant celle affichée : la dernière à avoir été présentée deux frames plus tôt,
+    // que le GPU a fini de lire
+    int slot = (displayedSlot + 1) % static_cast<int>(slots.size());
+    AVFrame* reference = av_frame_clone(frame);
+    if (!reference) {
+        return;
+    }
+    if (!lockSlot(slots[slot])) {
+        av_frame_free(&reference);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(converterMutex);
+        preparedSource = frame;
+        preparedFrame = reference;
+        preparedLayout = layout;
+        preparedSlot = slot;
+        writePending = true;
+    }
+    converterCondition.notify_all();
+}
+
+void SdlRenderer::converterThreadFunction() {
+    Tracer::setThreadName("texture converter");
+    ThreadCpuScope cpuScope("texture converter");
+    std::unique_lock<std::mutex> lock(converterMutex);
+    while (true) {
+        converterCondition.wait(lock, [this]() { return converterStopping || writePending; });
+        if (converterStopping) {
+            break;
+        }
+
+        const AVFrame* frame = preparedFrame;
+        AVPixelFormat layout = preparedLayout;
+        const TextureSlot& slot = slots[preparedSlot];
+        uint8_t* const data[3] = {slot.planes[0], slot.planes[1], slot.planes[2]};
+        const int linesize[3] = {slot.pitches[0], slot.pitches[1], slot.pitches[2]};
+        lock.unlock();
+
+        // Écriture directe dans la mémoire verrouillée : pas de copie intermédiaire par SDL
+        auto start = Clock::now();
+        bool written;
+        {
+            TraceScope span("write texture", frame->pts);
+            written = converter.convertInto(frame, layout, data, linesize);
+        }
+        auto elapsed = Clock::now() - start;
+
+        lock.lock();
+        windowWrite += elapsed;
+        writeSucceeded = written;
+        writePending = false;
+        converterCondition.notify_all();
+    }
+}
+
+int SdlRenderer::finishPrepared() {
+    TraceScope span("unlock texture", preparedFrame->pts);
+    bool written;
+    {
+        std::unique_lock<std::mutex> lock(converterMutex);
+        converterCondition.wait(lock, [this]() { return !writePending; });
+        written = writeSucceeded;
+    }
+
+    int slot = preparedSlot;
+    SDL_UnlockTexture(slots[slot].texture);
+    slots[slot].locked = false;
+
+    av_frame_free(&preparedFrame);
+    preparedSource = nullptr;
+    preparedSlot = -1;
+    return written ? slot : -1;
+}
+
+void SdlRenderer::abandonPrepared() {
+    if (preparedFrame) {
+        finishPrepared();
+    }
+}
+
+bool SdlRenderer::uploadFrame(const AVFrame* frame) {
+    AVPixelFormat layout = textureLayoutFor(frame->format);
+    {
+        TraceScope span("convert", frame->pts);
+        frame = converter.convert(frame, layout);
+    }
+    if (!frame) {
+        return false;
+    }
+
+    Uint32 format = layout == AV_PIX_FMT_NV12 ? SDL_PIXELFORMAT_NV12 : SDL_PIXELFORMAT_IYUV;
+    if (!ensureTextures(format, frame->width, frame->height)) {
+        return false;
+    }
+
+    // Les plans sont envoyés tels quels, avec leurs propres linesize (padding compris)
+    TraceScope span("update texture", frame->pts);
+    SDL_Texture* texture = slots[0].texture;
+    int result;
+    if (format == SDL_PIXELFORMAT_NV12) {
+        result = SDL_UpdateNVTexture(
+            texture,
+            nullptr,
+            frame->data[0], frame->linesize[0],
+            frame->data[1], frame->linesize[1]
+        );
+    } else {
+        result = SDL_UpdateYUVTexture(
+            texture,
+            nullptr,
+            frame->data[0], frame->linesize[0],
+            frame->data[1], frame->linesize[1],
+            frame->data[2], frame->linesize[2]
+        );
+    }
+
+    if (result != 0) {
+        Logger::logError("Texture upload failed: " + std::string(SDL_GetError()));
+        return false;
+    }
+    return true;
+}
+
+void SdlRenderer::renderFrame(AVFrame* frame) {
+    if (!frame) return;
+
+    auto start = Clock::now();
+    int slot = 0;
+    if (options.textureUpload == TextureUpload::Ring) {
+        // Frame non préparée (première frame, frame précédente jetée) : écrite maintenant
+        bool preparedAhead = preparedSource == frame;
+        prepareFrame(frame);
+        if (preparedSource != frame) {
+            return;
+        }
+        slot = finishPrepared();
+        if (slot < 0) {
+            return;
+        }
+        windowPreparedAhead += preparedAhead ? 1 : 0;
+    } else if (!uploadFrame(frame)) {
+        return;
+    }
+    windowUpload += Clock::now() - start;
+    windowFrames++;
+
+    displayedSlot = slot;
+    {
+        TraceScope span("present", frame->pts);
+        SDL_RenderClear(renderer);
+        SDL_RenderCopy(renderer, slots[slot].texture, nullptr, nullptr);
+        SDL_RenderPresent(renderer);
+    }
+    report(Clock::now());
+}
+
+void SdlRenderer::report(Clock::time_point now) {
+    if (now - lastReport < REPORT_INTERVAL || windowFrames == 0) {
+        return;
+    }
+
+    char message[192];
+    if (options.textureUpload == TextureUpload::Ring) {
+        double writeMs;
+        {
+            std::lock_guard<std::mutex> lock(converterMutex);
+            writeMs = windowWrite.count();
+            windowWrite = std::chrono::duration<double, std::milli>(0);
+        }
+        snprintf(message, sizeof(message),
+                 "Texture upload (ring): %.2f ms/frame on the render thread, %.2f ms/frame written by the "
+                 "converter thread, %.0f%% prepared ahead",
+                 windowUpload.count() / windowFrames, writeMs / windowFrames,
+                 100.0 * windowPreparedAhead / windowFrames);
+    } else {
+        snprintf(message, sizeof(message), "Texture upload (update): %.2f ms/frame on the render thread",
+                 windowUpload.count() / windowFrames);
+    }
+    Logger::logPerformance(message);
+
+    windowFrames = 0;
+    windowPreparedAhead = 0;
+    windowUpload = std::chrono::duration<double, std::milli>(0);
+    lastReport = now;
+}
+
+void SdlRenderer::cleanup() {
+    // La texture en cours d'écriture doit être déverrouillée avant l'arrêt du thread de conversion
+    if (renderer) {
+        abandonPrepared();
+    }
+    if (converterThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(converterMutex);
+            converterStopping = true;
+        }
+        converterCondition.notify_all();
+        converterThread.join();
+        converterStopping = false;
+    }
+    destroyTextures();
+
+    if (renderer) {
+        SDL_DestroyRenderer(renderer);
+        renderer = nullptr;
+    }
+
+    if (window) {
+        SDL_DestroyWindow(window);
+        window = nullptr;
+    }
+
+    converter.release();
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "Renderer.h"
+#include "FrameConverter.h"
+#include <SDL2/SDL.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Rendu plein écran KMSDRM : textures streaming YUV, vsync.
+// En mode Ring, la frame suivante est écrite par un thread de conversion directement dans
+// la mémoire d'une texture verrouillée (SDL_LockTexture) pendant que la précédente est affichée ;
+// le thread de rendu ne fait plus que déverrouiller, copier et présenter.
+class SdlRenderer : public Renderer {
+public:
+    explicit SdlRenderer(const RendererOptions& options = RendererOptions());
+    ~SdlRenderer() override;
+
+    bool initialize(int width, int height) override;
+    void cleanup() override;
+    void prepareFrame(const AVFrame* frame) override;
+    void renderFrame(AVFrame* frame) override;
+    // La frame préparée est abandonnée ; sa texture redevient libre
+    void abandonPrepared() override;
+    RendererBackend backend() const override { return RendererBackend::Sdl; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct TextureSlot {
+        SDL_Texture* texture;
+        bool locked;
+        // Plans de la mémoire verrouillée
+        uint8_t* planes[3];
+        int pitches[3];
+    };
+
+    // Disposition de texture (yuv420p ou nv12) retenue pour un format décodé, selon ce que le rendu accepte
+    AVPixelFormat textureLayoutFor(int pixelFormat) const;
+    // Recrée toutes les textures de l'anneau si le format ou la taille change
+    bool ensureTextures(Uint32 format, int width, int height);
+    void destroyTextures();
+    bool lockSlot(TextureSlot& slot);
+    // Mode Update : conversion et SDL_UpdateYUVTexture sur le thread de rendu
+    bool uploadFrame(const AVFrame* frame);
+    // Mode Ring : attend la fin de l'écriture puis déverrouille ; texture à présenter, -1 si l'écriture a échoué
+    int finishPrepared();
+    void converterThreadFunction();
+    void report(Clock::time_point now);
+
+    RendererOptions options;
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    std::vector<TextureSlot> slots;
+    Uint32 textureFormat;
+    int textureWidth;
+    int textureHeight;
+    int displayedSlot;  // -1 : rien d'affiché
+    // Formats YUV annoncés par le rendu SDL ; les autres sont émulés par SDL
+    bool iyuvSupported;
+    bool nv12Supported;
+
+    // Utilisé par le thread de conversion en mode Ring, par le thread de rendu en mode Update
+    FrameConverter converter;
+
+    // Frame en cours d'écriture dans slots[preparedSlot] ; preparedSource identifie la frame de l'appelant
+    std::thread converterThread;
+    std::mutex converterMutex;
+    std::condition_variable converterCondition;
+    const AVFrame* preparedSource;
+    AVFrame* preparedFrame;  // référence propre : l'appelant peut libérer sa frame à tout moment
+    AVPixelFormat preparedLayout;
+    int preparedSlot;
+    bool writePending;
+    bool writeSucceeded;
+    bool converterStopping;
+
+    // Temps par frame passé sur le thread de rendu avant la présentation (conversion + envoi,
+    // ou attente de l'écriture + déverrouillage), et temps d'écriture du thread de conversion
+    uint64_t windowFrames;
+    uint64_t windowPreparedAhead;
+    std::chrono::duration<double, std::milli> windowUpload;
+    std::chrono::duration<double, std::milli> windowWrite;
+    Clock::time_point lastReport;
+
+    // Une texture affichée, une en écriture, une libre pour la frame suivante si l'une est abandonnée
+    static constexpr int RING_SIZE = 3;
+    static constexpr std::chrono::seconds REPORT_INTERVAL{1};
+};
@@ -0,0 +1,61 @@
+#include "TelemetrySampler.h"
+#include <json/json.h>
+#include <cmath>
+
+// Une décimale suffit au tableau de bord et raccourcit le message
+static double rounded(double value) {
+    return std::round(value * 10.0) / 10.0;
+}
+
+TelemetrySampler::TelemetrySampler()
+    : presentedFrames(Metrics::counter(Metrics::PRESENTED_FRAMES))
+    , droppedFrames(Metrics::counter(Metrics::DROPPED_FRAMES))
+    , audioUnderruns(Metrics::counter(Metrics::AUDIO_UNDERRUNS))
+    , queueDepth(Metrics::gauge(Metrics::VIDEO_QUEUE_DEPTH))
+    , videoPacketDepth(Metrics::gauge(Metrics::VIDEO_PACKET_QUEUE_DEPTH))
+    , audioPacketDepth(Metrics::gauge(Metrics::AUDIO_PACKET_QUEUE_DEPTH))
+    , audioBuffer(Metrics::gauge(Metrics::AUDIO_BUFFER_MS))
+    , audioLatency(Metrics::gauge(Metrics::AUDIO_LATENCY_MS))
+    , drift(Metrics::gauge(Metrics::AV_DRIFT_MS))
+    , origin(Clock::now())
+    , lastSample(origin)
+    , lastPresented(presentedFrames.get()) {
+}
+
+std::string TelemetrySampler::sample() {
+    Clock::time_point now = Clock::now();
+    uint64_t presented = presentedFrames.get();
+    double elapsed = std::chrono::duration<double>(now - lastSample).count();
+
+    Json::Value root;
+    root["type"] = "telemetry";
+    root["uptime"] = rounded(std::chrono::duration<double>(now - origin).count());
+    root["fps"] = rounded(elapsed > 0.0 ? (presented - lastPresented) / elapsed : 0.0);
+    // Files du pipeline : paquets démultiplexés, frames décodées, PCM rééchantillonné
+    root["videoPacketQueue"] = static_cast<int>(videoPacketDepth.get());
+    root["audioPacketQueue"] = static_cast<int>(audioPacketDepth.get());
+    root["videoQueueFrames"] = static_cast<int>(queueDepth.get());
+    root["audioBufferMs"] = rounded(audioBuffer.get());
+    root["audioLatencyMs"] = rounded(audioLatency.get());
+    root["presentedFrames"] = Json::UInt64(presented);
+    root["droppedFrames"] = Json::UInt64(droppedFrames.get());
+    root["audioUnderruns"] = Json::UInt64(audioUnderruns.get());
+    root["avDriftMs"] = rounded(drift.get());
+    // Temps CPU cumulé par thread, en secondes. Tableau et non objet : plusieurs threads
+    // portent le même nom (convertisseurs de textures, sorties d'un même écran du mur)
+    Json::Value threads(Json::arrayValue);
+    for (const Metrics::ThreadCpuTime& thread : Metrics::threadCpuTimes()) {
+        Json::Value entry;
+        entry["name"] = thread.name;
+        entry["seconds"] = std::round(thread.seconds * 1000.0) / 1000.0;
+        threads.append(entry);
+    }
+    root["cpuSeconds"] = threads;
+
+    lastSample = now;
+    lastPresented = presented;
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, root);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "../utils/Metrics.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Instantané compact des métriques du lecteur pour la télémétrie WebSocket, sérialisé en
+// JSON sur une ligne. Le débit d'images couvre l'intervalle depuis l'instantané précédent.
+// Utilisé uniquement par le thread du serveur WebSocket.
+class TelemetrySampler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TelemetrySampler();
+    std::string sample();
+
+private:
+    Counter& presentedFrames;
+    Counter& droppedFrames;
+    Counter& audioUnderruns;
+    Gauge& queueDepth;
+    Gauge& videoPacketDepth;
+    Gauge& audioPacketDepth;
+    Gauge& audioBuffer;
+    Gauge& audioLatency;
+    Gauge& drift;
+
+    Clock::time_point origin;
+    Clock::time_point lastSample;
+    uint64_t lastPresented;
+};
@@ -1,9 +1,15 @@
 #include "VideoDecoder.h"
 #include "AudioManager.h"
 #include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/StartupTimeline.h"
+#include "../utils/Tracer.h"
+#include <algorithm>
+#include <cmath>
+#include <sys/resource.h>
 
 extern "C" {
-    #include <libavutil/imgutils.h>  // Ajout de cet include pour av_image_copy
+    #include <libavutil/imgutils.h>  // av_image_get_buffer_size
 }
 
 VideoDecoder::VideoDecoder()
@@ -13,29 +19,191 @@ VideoDecoder::VideoDecoder()
     , videoStreamIndex(-1)
     , audioStreamIndex(-1)
     , audioManager(nullptr)
-    , isRunning(false) {
+    , videoPacketQueue(VIDEO_PACKET_QUEUE_SIZE)
+    , audioPacketQueue(AUDIO_PACKET_QUEUE_SIZE)
+    , frameQueue(MAX_QUEUED_FRAMES)
+    , videoBudget(config.videoQueue)
+    , frameDuration(1.0 / 30.0)
+    , isRunning(false)
+    , seekRequested(false)
+    , startupWaiting(false)
+    , seekTargetPts(AV_NOPTS_VALUE)
+    , seekGeneration(0)
+    , seekRequestedAtNs(0)
+    , audioDecodingEnabled(false)
+    , videoFrameCount(0)
+    , audioFrameCount(0)
+    , clipStartPts(AV_NOPTS_VALUE)
+    , clipEndPts(AV_NOPTS_VALUE)
+    , loopOffsetSeconds(0.0)
+    , replayOffsetSeconds(0.0)
+    , replayingFromCache(false)
+    , demuxGeneration(0)
+    , videoPtsOffset(0)
+    , videoDiscardBefore(AV_NOPTS_VALUE)
+    , nextVideoFrameStartsLoop(false)
+    , audioPtsOffset(0)
+    , audioDiscardBefore(AV_NOPTS_VALUE)
+    , videoGeneration(0)
+    , seekDiscardedFrames(0)
+    , lastDequeuedPts(AV_NOPTS_VALUE)
+    , frameGapSumUs(0)
+    , frameGapCount(0)
+    , loopCount(0)
+    , lastLoopGapUs(0)
+    , maxLoopGapUs(0)
+    , averageFrameGapUs(0)
+    , presentedGeneration(0)
+    , lastSeekLatencyUs(0)
+    , discontinuity(false)
+    , requestedDegradation(0)
+    , appliedDegradation(0)
+    , degradedFrames(0)
+    , lastPipelineReport(std::chrono::steady_clock::now())
+    , lastCpuTimeUs(0)
+    , processCpuPercent(0.0)
+    , copiedBytes(0)
+    , copiedBytesPerSecond(0)
+    , lastCopyReport(std::chrono::steady_clock::now())
+    , queueLatencySumUs(0)
+    , queueLatencyMaxUs(0)
+    , queueLatencySamples(0)
+    , averageQueueLatencyUs(0)
+    , lastLatencyReport(std::chrono::steady_clock::now()) {
 }
 
 VideoDecoder::~VideoDecoder() {
     stopDecoding();
 }
 
-bool VideoDecoder::initialize(const std::string& path) {
+size_t VideoDecoder::frameMemorySize(const AVFrame* frame) {
+    size_t bytes = 0;
+    for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i]; i++) {
+        bytes += frame->buf[i]->size;
+    }
+    if (bytes == 0 && frame->width > 0) {
+        bytes = std::max(0, av_image_get_buffer_size(static_cast<AVPixelFormat>(frame->format),
+                                                     frame->width, frame->height, 1));
+    }
+    return bytes;
+}
+
+const char* VideoDecoder::threadingName(DecoderThreading threading) {
+    switch (threading) {
+        case DecoderThreading::Auto: return "auto";
+        case DecoderThreading::Frame: return "frame";
+        case DecoderThreading::Slice: return "slice";
+        case DecoderThreading::Off: return "off";
+    }
+    return "unknown";
+}
+
+bool VideoDecoder::parseThreading(const std::string& name, DecoderThreading& threading) {
+    for (DecoderThreading candidate : {DecoderThreading::Auto, DecoderThreading::Frame,
+                                       DecoderThreading::Slice, DecoderThreading::Off}) {
+        if (name == threadingName(candidate)) {
+            threading = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* VideoDecoder::loopModeName(LoopMode mode) {
+    switch (mode) {
+        case LoopMode::Seek: return "seek";
+        case LoopMode::Gapless: return "gapless";
+        case LoopMode::Cache: return "cache";
+    }
+    return "unknown";
+}
+
+bool VideoDecoder::parseLoopMode(const std::string& name, LoopMode& mode) {
+    for (LoopMode candidate : {LoopMode::Seek, LoopMode::Gapless, LoopMode::Cache}) {
+        if (name == loopModeName(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void VideoDecoder::applyDegradation(AVCodecContext* context, int level) {
+    // Chaque niveau ajoute une économie : filtre de boucle, puis IDCT, puis décodage
+    // des frames non référencées, enfin filtre de boucle sur toutes les frames
+    context->skip_loop_filter = level >= 4 ? AVDISCARD_ALL : level >= 1 ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    context->skip_idct = level >= 2 ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    context->skip_frame = level >= 3 ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+}
+
+void VideoDecoder::configureThreading(AVCodecContext* context, const DecoderConfig& config) {
+    // Les décodeurs matériels (V4L2 M2M) gèrent leur propre parallélisme
+    if (context->codec && (context->codec->capabilities & AV_CODEC_CAP_HARDWARE)) {
+        context->thread_count = 1;
+        context->thread_type = 0;
+        return;
+    }
+
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int threads = config.threadCount > 0 ? config.threadCount : cores;
+
+    switch (config.threading) {
+        case DecoderThreading::Auto:
+            // Le frame threading passe mieux à l'échelle mais ajoute une frame de latence par
+            // thread ; libavcodec retombe sur le slice threading si le codec ne le supporte pas
+            context->thread_type = cores > 1 ? (FF_THREAD_FRAME | FF_THREAD_SLICE) : 0;
+            context->thread_count = cores > 1 ? threads : 1;
+            break;
+        case DecoderThreading::Frame:
+            context->thread_type = FF_THREAD_FRAME;
+            context->thread_count = threads;
+            break;
+        case DecoderThreading::Slice:
+            context->thread_type = FF_THREAD_SLICE;
+            context->thread_count = threads;
+            break;
+        case DecoderThreading::Off:
+            context->thread_type = 0;
+            context->thread_count = 1;
+            break;
+    }
+}
+
+bool VideoDecoder::initialize(const std::string& path, StartupTimeline* timeline) {
+    auto phaseStart = std::chrono::steady_clock::now();
+    auto endPhase = [&](const char* name) {
+        if (timeline) {
+            timeline->record(name, phaseStart);
+        }
+        phaseStart = std::chrono::steady_clock::now();
+    };
+
+    videoPath = path;
     formatContext = avformat_alloc_context();
     if (!formatContext) {
         Logger::logError("Could not allocate format context");
         return false;
     }
 
+    // Sonder moins de données raccourcit l'ouverture, au risque de rater un flux tardif
+    if (config.probeSize > 0) {
+        formatContext->probesize = config.probeSize;
+    }
+    if (config.analyzeDurationUs > 0) {
+        formatContext->max_analyze_duration = config.analyzeDurationUs;
+    }
+
     if (avformat_open_input(&formatContext, path.c_str(), nullptr, nullptr) < 0) {
         Logger::logError("Could not open video file");
         return false;
     }
+    endPhase("open input");
 
     if (avformat_find_stream_info(formatContext, nullptr) < 0) {
         Logger::logError("Could not find stream info");
         return false;
     }
+    endPhase("probe streams");
 
     // Find video and audio streams
     for (unsigned int i = 0; i < formatContext->nb_streams; i++) {
@@ -51,6 +219,12 @@ bool VideoDecoder::initialize(const std::string& path) {
         return false;
     }
 
+    // Durée d'une frame, pour borner la file vidéo en temps de présentation
+    AVRational frameRate = av_guess_frame_rate(formatContext, formatContext->streams[videoStreamIndex], nullptr);
+    if (frameRate.num > 0 && frameRate.den > 0) {
+        frameDuration = av_q2d(av_inv_q(frameRate));
+    }
+
     // Vérifier le codec de la vidéo
     const AVCodec* videoCodec = NULL;
     if (formatContext->streams[videoStreamIndex]->codecpar->codec_id == AV_CODEC_ID_HEVC) {
@@ -86,18 +260,47 @@ bool VideoDecoder::initialize(const std::string& path) {
     }
 
     // Configuration du décodage - IMPORTANT
-    codecContext->thread_count = 1;  // Désactiver le multi-threading pour éviter les problèmes
-    codecContext->flags |= AV_CODEC_FLAG_LOW_DELAY;  // Réduire la latence
+    configureThreading(codecContext, config);
+    if (!(codecContext->thread_type & FF_THREAD_FRAME)) {
+        // LOW_DELAY désactive le frame threading de libavcodec : on ne le garde que sans lui
+        codecContext->flags |= AV_CODEC_FLAG_LOW_DELAY;  // Réduire la latence
+    }
 
     // Ajouter ces options pour le codec context
     codecContext->flags |= AV_CODEC_FLAG_OUTPUT_CORRUPT;  // Permet de continuer même avec des frames corrompues
     codecContext->err_recognition = 0;  // Moins strict sur les erreurs
 
-    if (avcodec_open2(codecContext, videoCodec, nullptr) < 0) {
+    // Le décodeur V4L2 M2M a un nombre fixe de buffers de capture. Les frames en file
+    // gardent une référence sur ces buffers, il en faut donc assez pour remplir le budget.
+    AVDictionary* codecOptions = nullptr;
+    if (std::string(videoCodec->name).find("v4l2m2m") != std::string::npos) {
+        size_t frameBytes = std::max(1, av_image_get_buffer_size(
+            codecContext->pix_fmt == AV_PIX_FMT_NONE ? AV_PIX_FMT_YUV420P : codecContext->pix_fmt,
+            codecContext->width, codecContext->height, 1));
+        size_t budgetFrames = std::min({MAX_QUEUED_FRAMES,
+                                        config.videoQueue.maxBytes / frameBytes + 1,
+                                        static_cast<size_t>(config.videoQueue.maxSeconds / frameDuration) + 1});
+        av_dict_set_int(&codecOptions, "num_capture_buffers", budgetFrames + 4, 0);
+    }
+
+    int openResult = avcodec_open2(codecContext, videoCodec, &codecOptions);
+    av_dict_free(&codecOptions);
+    if (openResult < 0) {
         Logger::logError("Could not open video codec");
         return false;
     }
 
+    std::string activeThreading = "none";
+    if (codecContext->active_thread_type & FF_THREAD_FRAME) {
+        activeThreading = "frame";
+    } else if (codecContext->active_thread_type & FF_THREAD_SLICE) {
+        activeThreading = "slice";
+    }
+    Logger::logInfo("Video decoder " + std::string(videoCodec->name) + " using " +
+                    std::to_string(codecContext->thread_count) + " thread(s), " +
+                    activeThreading + " threading (requested " + threadingName(config.threading) + ")");
+    endPhase("open video decoder");
+
     // Initialize audio codec if available
     if (audioStreamIndex >= 0) {
         const AVCodec* audioCodec = avcodec_find_decoder(formatContext->streams[audioStreamIndex]->codecpar->codec_id);
@@ -123,48 +326,208 @@ bool VideoDecoder::initialize(const std::string& path) {
         }
 
         Logger::logInfo("Audio codec initialized successfully");
+        endPhase("open audio decoder");
     }
 
-    // Ajouter un délai initial pour permettre le remplissage des buffers
-    Logger::logInfo("Waiting for initial buffering...");
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    // Index des keyframes : projeté depuis le fichier compagnon, ou construit en arrière-plan
+    keyframeIndex.open(path, videoStreamIndex);
+    endPhase("keyframe index");
 
     return true;
 }
 
 void VideoDecoder::startDecoding() {
     isRunning = true;
-    decodeThread = std::thread(&VideoDecoder::decodeThreadFunction, this);
+    videoPacketQueue.resume();
+    audioPacketQueue.resume();
+    frameQueue.resume();
+    videoBudget.setLimits(config.videoQueue);
+    videoBudget.resume();
+
+    audioDecodingEnabled = audioCodecContext && audioManager;
+    if (config.loopMode == LoopMode::Cache) {
+        size_t estimatedFrames = formatContext->duration > 0
+            ? static_cast<size_t>(formatContext->duration / (AV_TIME_BASE * frameDuration)) : 0;
+        loopCache.reset(config.loopCacheBytes, estimatedFrames, getVideoStream()->time_base, audioDecodingEnabled);
+    }
+    scaler.setTarget(config.downscaleWidth, config.downscaleHeight);
+    videoDecodeThread = std::thread(&VideoDecoder::videoDecodeThreadFunction, this);
+    if (audioDecodingEnabled) {
+        audioDecodeThread = std::thread(&VideoDecoder::audioDecodeThreadFunction, this);
+    }
+    demuxThread = std::thread(&VideoDecoder::demuxThreadFunction, this);
+
+    if (config.loopMode == LoopMode::Gapless) {
+        preroller.start(videoPath, config, videoStreamIndex, audioDecodingEnabled ? audioStreamIndex : -1);
+    }
 }
 
 void VideoDecoder::stopDecoding() {
     isRunning = false;
-    condition.notify_all();
+    // Le thread audio peut attendre de la place dans le tampon PCM, que rien ne vide en pause
+    if (audioManager) {
+        audioManager->interrupt();
+    }
+    videoPacketQueue.interrupt();
+    audioPacketQueue.interrupt();
+    frameQueue.interrupt();
+    videoBudget.interrupt();
     
-    if (decodeThread.joinable()) {
-        decodeThread.join();
+    for (std::thread* thread : {&demuxThread, &videoDecodeThread, &audioDecodeThread}) {
+        if (thread->joinable()) {
+            thread->join();
+        }
+    }
+
+    // Les threads de décodage ne lisent plus les frames pré-décodées ni le cache
+    preroller.stop();
+    keyframeIndex.close();
+    loopCache.clear();
+    replayingFromCache = false;
+
+    // Les threads sont arrêtés, on peut vider les files sans concurrence
+    QueuedPacket packetEntry;
+    for (auto* queue : {&videoPacketQueue, &audioPacketQueue}) {
+        while (queue->tryPop(packetEntry)) {
+            av_packet_free(&packetEntry.packet);
+        }
+    }
+    QueuedFrame entry;
+    while (frameQueue.tryPop(entry)) {
+        videoBudget.release(entry.bytes, frameDuration);
+        av_frame_free(&entry.frame);
     }
 
     // Cleanup resources
     if (codecContext) {
         avcodec_free_context(&codecContext);
     }
+    if (audioCodecContext) {
+        avcodec_free_context(&audioCodecContext);
+    }
     if (formatContext) {
         avformat_close_input(&formatContext);
     }
 }
 
-AVFrame* VideoDecoder::getNextFrame() {
-    std::unique_lock<std::mutex> lock(mutex);
-    if (frameQueue.empty()) {
-        return nullptr;
+AVFrame* VideoDecoder::getNextFrame(std::chrono::milliseconds timeout) {
+    QueuedFrame entry;
+    while (true) {
+        bool available = timeout.count() > 0 ? frameQueue.waitPop(entry, timeout)
+                                             : frameQueue.tryPop(entry);
+        if (!available) {
+            return nullptr;
+        }
+
+        videoBudget.release(entry.bytes, frameDuration);
+        if (entry.generation == seekGeneration) {
+            break;
+        }
+        av_frame_free(&entry.frame);  // décodée avant le dernier seek
     }
-    
-    AVFrame* frame = frameQueue.front();
-    frameQueue.pop();
-    lock.unlock();
-    condition.notify_one();
-    return frame;
+
+    static Gauge& queueDepth = Metrics::gauge(Metrics::VIDEO_QUEUE_DEPTH);
+    queueDepth.set(static_cast<double>(frameQueue.size()));
+    recordQueueLatency(entry.enqueuedAt);
+    recordFrameGap(entry);
+    if (entry.generation != presentedGeneration) {
+        presentedGeneration = entry.generation;
+        discontinuity = true;
+        reportSeekLatency();
+    }
+    return entry.frame;
+}
+
+bool VideoDecoder::startupFramesReady() const {
+    const QueueLimits& limits = videoBudget.getLimits();
+    return !isRunning || frameQueue.size() >= MIN_FRAMES_TO_START ||
+           videoBudget.bytes() >= limits.maxBytes || videoBudget.seconds() >= limits.maxSeconds;
+}
+
+bool VideoDecoder::waitForStartupFrames(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(startupMutex);
+    startupWaiting = true;
+    bool ready = startupCondition.wait_for(lock, timeout, [this] { return startupFramesReady(); });
+    startupWaiting = false;
+    Logger::logInfo("Startup buffering " + std::string(ready ? "done" : "timed out") + " with " +
+                    std::to_string(frameQueue.size()) + " frames");
+    return ready;
+}
+
+void VideoDecoder::reportSeekLatency() {
+    int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    lastSeekLatencyUs = (nowNs - seekRequestedAtNs) / 1000;
+    Logger::logPerformance("Seek: first frame after " + std::to_string(lastSeekLatencyUs / 1000.0) +
+                           " ms, " + std::to_string(seekDiscardedFrames.load()) +
+                           " frames decoded and discarded after the keyframe");
+}
+
+void VideoDecoder::recordFrameGap(const QueuedFrame& entry) {
+    auto now = std::chrono::steady_clock::now();
+    if (lastDequeueTime != std::chrono::steady_clock::time_point()) {
+        uint64_t gapUs = std::chrono::duration_cast<std::chrono::microseconds>(now - lastDequeueTime).count();
+        if (entry.loopStart) {
+            averageFrameGapUs = frameGapCount > 0 ? frameGapSumUs / frameGapCount : 0;
+            lastLoopGapUs = gapUs;
+            maxLoopGapUs = std::max(maxLoopGapUs.load(), gapUs);
+            loopCount++;
+
+            std::string ptsDelta = "n/a";
+            if (entry.frame->pts != AV_NOPTS_VALUE && lastDequeuedPts != AV_NOPTS_VALUE) {
+                double deltaMs = (entry.frame->pts - lastDequeuedPts) * av_q2d(getVideoStream()->time_base) * 1000.0;
+                ptsDelta = std::to_string(static_cast<int>(deltaMs + 0.5)) + " ms";
+            }
+            Logger::logPerformance("Loop boundary " + std::to_string(loopCount.load()) + ": inter-frame gap " +
+                                   std::to_string(gapUs / 1000.0) + " ms (average " +
+                                   std::to_string(averageFrameGapUs / 1000.0) + " ms), pts delta " + ptsDelta +
+                                   " (frame duration " + std::to_string(static_cast<int>(frameDuration * 1000 + 0.5)) + " ms)");
+            frameGapSumUs = 0;
+            frameGapCount = 0;
+        } else {
+            frameGapSumUs += gapUs;
+            frameGapCount++;
+        }
+    }
+    lastDequeueTime = now;
+    lastDequeuedPts = entry.frame->pts;
+}
+
+VideoDecoder::LoopStats VideoDecoder::getLoopStats() const {
+    return {loopCount, lastLoopGapUs / 1000.0, maxLoopGapUs / 1000.0, averageFrameGapUs / 1000.0};
+}
+
+void VideoDecoder::recordQueueLatency(std::chrono::steady_clock::time_point enqueuedAt) {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(now - enqueuedAt).count();
+    queueLatencySumUs += latencyUs;
+    queueLatencyMaxUs = std::max(queueLatencyMaxUs, latencyUs);
+    queueLatencySamples++;
+
+    if (now - lastLatencyReport < std::chrono::seconds(1)) {
+        return;
+    }
+
+    averageQueueLatencyUs = queueLatencySumUs / queueLatencySamples;
+    Logger::logPerformance("Frame queue latency: avg " + std::to_string(averageQueueLatencyUs.load()) +
+                           " us, max " + std::to_string(queueLatencyMaxUs) +
+                           " us over " + std::to_string(queueLatencySamples) + " frames");
+    queueLatencySumUs = 0;
+    queueLatencyMaxUs = 0;
+    queueLatencySamples = 0;
+    lastLatencyReport = now;
+}
+
+void VideoDecoder::reportCopyRate() {
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = now - lastCopyReport;
+    if (elapsed.count() < 1.0) {
+        return;
+    }
+
+    copiedBytesPerSecond = static_cast<uint64_t>(copiedBytes.exchange(0) / elapsed.count());
+    lastCopyReport = now;
+    Logger::logPerformance("Frame copy rate: " + std::to_string(copiedBytesPerSecond.load()) + " bytes/s");
 }
 
 AVStream* VideoDecoder::getVideoStream() const {
@@ -174,6 +537,11 @@ AVStream* VideoDecoder::getVideoStream() const {
     return nullptr;
 }
 
+void VideoDecoder::getOutputSize(int& width, int& height) const {
+    FrameScaler::fitWithin(codecContext->width, codecContext->height,
+                           config.downscaleWidth, config.downscaleHeight, width, height);
+}
+
 AVStream* VideoDecoder::getAudioStream() const {
     if (audioStreamIndex >= 0) {
         return formatContext->streams[audioStreamIndex];
@@ -181,161 +549,722 @@ AVStream* VideoDecoder::getAudioStream() const {
     return nullptr;
 }
 
-void VideoDecoder::decodeThreadFunction() {
-    AVPacket* packet = av_packet_alloc();
-    AVFrame* frame = av_frame_alloc();
-    
-    int64_t video_frame_count = 0;
-    int64_t audio_frame_count = 0;
-    
-    Logger::logInfo("Starting decode thread, buffering initial frames...");
-    
-    // Attendre un peu avant de commencer le décodage vidéo
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    
+VideoDecoder::StageOccupancy VideoDecoder::StageStats::occupancy() const {
+    double blocked = blockedPercent;
+    double starved = starvedPercent;
+    return {std::max(0.0, 100.0 - blocked - starved), blocked, starved};
+}
+
+VideoDecoder::PipelineStats VideoDecoder::getPipelineStats() const {
+    PipelineStats stats;
+    stats.videoPackets = videoPacketQueue.size();
+    stats.videoPacketCapacity = videoPacketQueue.capacity();
+    stats.audioPackets = audioPacketQueue.size();
+    stats.audioPacketCapacity = audioPacketQueue.capacity();
+    stats.videoFrames = frameQueue.size();
+    stats.videoFrameCapacity = frameQueue.capacity();
+    stats.videoQueueBytes = videoBudget.bytes();
+    stats.videoQueueSeconds = videoBudget.seconds();
+    stats.audioUnderruns = audioManager ? audioManager->getUnderrunCount() : 0;
+    stats.audioQueueBytes = audioManager ? audioManager->getQueuedBytes() : 0;
+    stats.audioQueueSeconds = audioManager ? audioManager->getQueuedSeconds() : 0.0;
+    stats.demux = demuxStats.occupancy();
+    stats.videoDecode = videoDecodeStats.occupancy();
+    stats.audioDecode = audioDecodeStats.occupancy();
+    stats.processCpuPercent = processCpuPercent;
+    return stats;
+}
+
+void VideoDecoder::reportPipelineStats() {
+    auto now = std::chrono::steady_clock::now();
+    double elapsedUs = std::chrono::duration<double, std::micro>(now - lastPipelineReport).count();
+    if (elapsedUs < 1e6) {
+        return;
+    }
+    lastPipelineReport = now;
+
+    for (StageStats* stage : {&demuxStats, &videoDecodeStats, &audioDecodeStats}) {
+        stage->blockedPercent = std::min(100.0, stage->blockedUs.exchange(0) * 100.0 / elapsedUs);
+        stage->starvedPercent = std::min(100.0, stage->starvedUs.exchange(0) * 100.0 / elapsedUs);
+    }
+    updateCpuUsage(elapsedUs);
+
+    auto percent = [](double value) { return std::to_string(static_cast<int>(value + 0.5)) + "%"; };
+    auto budget = [](size_t bytes, double seconds) {
+        return " (" + std::to_string(bytes / (1024 * 1024)) + " MB, " +
+               std::to_string(static_cast<int>(seconds * 1000)) + " ms)";
+    };
+    auto describe = [&](const std::string& name, const StageOccupancy& stage) {
+        return name + " busy " + percent(stage.busyPercent) +
+               " blocked " + percent(stage.blockedPercent) +
+               " starved " + percent(stage.starvedPercent);
+    };
+
+    PipelineStats stats = getPipelineStats();
+    std::string report = "Pipeline: video packets " + std::to_string(stats.videoPackets) + "/" +
+                         std::to_string(stats.videoPacketCapacity) +
+                         ", video frames " + std::to_string(stats.videoFrames) +
+                         budget(stats.videoQueueBytes, stats.videoQueueSeconds);
+    if (audioDecodingEnabled) {
+        report += ", audio packets " + std::to_string(stats.audioPackets) + "/" +
+                  std::to_string(stats.audioPacketCapacity) +
+                  ", audio PCM" + budget(stats.audioQueueBytes, stats.audioQueueSeconds) +
+                  ", audio underruns " + std::to_string(stats.audioUnderruns);
+    }
+    report += " | " + describe("demux", stats.demux) +
+              " | " + describe("video decode", stats.videoDecode);
+    if (audioDecodingEnabled) {
+        report += " | " + describe("audio decode", stats.audioDecode);
+    }
+    if (config.loopMode == LoopMode::Cache) {
+        LoopCache::Stats cache = loopCache.getStats();
+        report += " | loop cache " + std::string(LoopCache::stateName(cache.state)) + " " +
+                  LoopCache::storageName(cache.storage) + " " + std::to_string(cache.bytes / (1024 * 1024)) +
+                  " MB, " + std::to_string(cache.videoFrames) + " frames";
+    }
+    report += " | CPU " + percent(stats.processCpuPercent);
+    Logger::logPerformance(report);
+}
+
+void VideoDecoder::updateCpuUsage(double elapsedUs) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return;
+    }
+    uint64_t cpuTimeUs = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL +
+                         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    if (lastCpuTimeUs > 0) {
+        processCpuPercent = (cpuTimeUs - lastCpuTimeUs) * 100.0 / elapsedUs;
+    }
+    lastCpuTimeUs = cpuTimeUs;
+}
+
+static int64_t toStreamTime(double seconds, AVRational timeBase) {
+    return static_cast<int64_t>(std::llround(seconds / av_q2d(timeBase)));
+}
+
+void VideoDecoder::pushMarker(PacketMarker marker, int64_t seekPts) {
+    pushPacket(videoPacketQueue, {nullptr, marker, loopOffsetSeconds, seekPts, demuxGeneration});
+    if (audioDecodingEnabled) {
+        pushPacket(audioPacketQueue, {nullptr, marker, loopOffsetSeconds, seekPts, demuxGeneration});
+    }
+}
+
+void VideoDecoder::requestSeek(int64_t targetPts) {
+    seekTargetPts = targetPts;
+    seekRequestedAtNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    seekGeneration++;
+    seekRequested = true;
+}
+
+void VideoDecoder::seekTo(double seconds) {
+    AVStream* stream = getVideoStream();
+    int64_t start = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    requestSeek(start + toStreamTime(std::max(0.0, seconds), stream->time_base));
+}
+
+void VideoDecoder::seekToFrame(int64_t frameNumber) {
+    int64_t pts;
+    if (frameNumber >= 0 && keyframeIndex.getFramePts(static_cast<size_t>(frameNumber), pts)) {
+        requestSeek(pts);
+        return;
+    }
+    seekTo(frameNumber * frameDuration);
+}
+
+void VideoDecoder::performSeek() {
+    demuxGeneration = seekGeneration;
+    int64_t target = seekTargetPts;
+    if (target == AV_NOPTS_VALUE) {
+        av_seek_frame(formatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
+        pushMarker(PacketMarker::Flush);
+        return;
+    }
+
+    // Avec l'index, la keyframe est connue exactement ; sinon le démultiplexeur la cherche
+    AVRational timeBase = getVideoStream()->time_base;
+    const KeyframeIndex::Entry* keyframe = keyframeIndex.findKeyframe(target);
+    int64_t keyframePts = keyframe ? keyframe->pts : target;
+    if (av_seek_frame(formatContext, videoStreamIndex, keyframePts, AVSEEK_FLAG_BACKWARD) < 0) {
+        Logger::logError("Seek to " + std::to_string(target * av_q2d(timeBase)) + " s failed");
+        return;
+    }
+    Logger::logInfo("Seek to " + std::to_string(target * av_q2d(timeBase)) + " s from keyframe at " +
+                    std::to_string(keyframePts * av_q2d(timeBase)) + " s" +
+                    (keyframe ? " (index)" : " (demuxer)"));
+    pushMarker(PacketMarker::Flush, target);
+}
+
+void VideoDecoder::trackClipBounds(const AVPacket* packet) {
+    if (packet->pts == AV_NOPTS_VALUE) {
+        return;
+    }
+
+    AVRational timeBase = formatContext->streams[videoStreamIndex]->time_base;
+    int64_t duration = packet->duration > 0 ? packet->duration : toStreamTime(frameDuration, timeBase);
+    if (clipStartPts == AV_NOPTS_VALUE || packet->pts < clipStartPts) {
+        clipStartPts = packet->pts;
+    }
+    if (clipEndPts == AV_NOPTS_VALUE || packet->pts + duration > clipEndPts) {
+        clipEndPts = packet->pts + duration;
+    }
+}
+
+void VideoDecoder::loopToStart() {
+    // Les PTS de la boucle suivante sont décalés de la durée du clip pour rester continus
+    if (clipStartPts != AV_NOPTS_VALUE) {
+        loopOffsetSeconds += (clipEndPts - clipStartPts) * av_q2d(formatContext->streams[videoStreamIndex]->time_base);
+    }
+
+    if (config.loopMode == LoopMode::Gapless && preroller.isReady()) {
+        Logger::logInfo("End of file reached, looping from pre-decoded start");
+        if (preroller.resumesAtKeyframe()) {
+            av_seek_frame(formatContext, videoStreamIndex, preroller.getResumePts(), AVSEEK_FLAG_BACKWARD);
+        } else {
+            av_seek_frame(formatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
+        }
+        pushMarker(PacketMarker::Loop);
+    } else if (config.loopMode == LoopMode::Cache && !loopCache.isAbandoned()) {
+        Logger::logInfo("End of file reached, replaying from loop cache");
+        // Le fichier reste positionné au début au cas où le cache serait abandonné en fin de décodage
+        av_seek_frame(formatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
+        replayingFromCache = true;
+        pushMarker(PacketMarker::Replay);
+    } else {
+        Logger::logInfo("End of file reached, seeking to start");
+        av_seek_frame(formatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
+        pushMarker(PacketMarker::EndOfStream);
+    }
+}
+
+void VideoDecoder::idleWhileReplaying() {
+    // Plus rien à lire tant que les boucles sont servies depuis le cache ; un seek
+    // redémarre simplement la relecture du cache
+    while (isRunning && !loopCache.isAbandoned()) {
+        if (seekRequested) {
+            // La relecture a pu enchaîner plusieurs boucles : comme en fin de clip, les PTS
+            // reprennent après la boucle en cours pour rester croissants
+            loopOffsetSeconds = std::max(loopOffsetSeconds, replayOffsetSeconds.load()) + loopCache.getClipSeconds();
+            if (seekTargetPts != AV_NOPTS_VALUE) {
+                break;  // seek en cours de clip : le démultiplexeur reprend depuis la keyframe
+            }
+            seekRequested = false;
+            demuxGeneration = seekGeneration;
+            pushMarker(PacketMarker::Flush);
+            pushMarker(PacketMarker::Replay);
+        }
+        reportPipelineStats();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    // Seek en cours de clip, ou cache abandonné en fin de premier passage : reprise du décodage
+    replayingFromCache = false;
+}
+
+bool VideoDecoder::pushPacket(SPSCRingBuffer<QueuedPacket>& queue, const QueuedPacket& entry) {
+    if (queue.tryPush(entry)) {
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (isRunning && !queue.waitPush(entry, std::chrono::milliseconds(100))) {
+    }
+    demuxStats.blockedUs += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return isRunning;
+}
+
+bool VideoDecoder::popPacket(SPSCRingBuffer<QueuedPacket>& queue, QueuedPacket& entry, StageStats& stats) {
+    static Gauge& videoPacketDepth = Metrics::gauge(Metrics::VIDEO_PACKET_QUEUE_DEPTH);
+    static Gauge& audioPacketDepth = Metrics::gauge(Metrics::AUDIO_PACKET_QUEUE_DEPTH);
+    Gauge& depth = &queue == &videoPacketQueue ? videoPacketDepth : audioPacketDepth;
+    if (queue.tryPop(entry)) {
+        depth.set(static_cast<double>(queue.size()));
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool popped = false;
+    while (isRunning && !(popped = queue.waitPop(entry, std::chrono::milliseconds(100)))) {
+    }
+    stats.starvedUs += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    depth.set(static_cast<double>(queue.size()));
+    return popped;
+}
+
+void VideoDecoder::demuxThreadFunction() {
+    Logger::logInfo("Starting demux thread");
+    Tracer::setThreadName("demux");
+    ThreadCpuScope cpuScope("demux");
+
     while (isRunning) {
+        if (replayingFromCache) {
+            idleWhileReplaying();
+            continue;
+        }
+
+        if (seekRequested.exchange(false)) {
+            performSeek();
+            continue;
+        }
+
+        AVPacket* packet = av_packet_alloc();
+        if (!packet) {
+            Logger::logError("Failed to allocate packet");
+            break;
+        }
+
+        int ret;
         {
-            std::unique_lock<std::mutex> lock(mutex);
-            if (frameQueue.size() >= MAX_QUEUE_SIZE) {
-                condition.wait(lock);
+            TraceScope span("demux");
+            ret = av_read_frame(formatContext, packet);
+            span.setPts(ret < 0 ? Tracer::NO_PTS : packet->pts);
+        }
+        if (ret < 0) {
+            av_packet_free(&packet);
+            if (ret == AVERROR_EOF) {
+                loopToStart();
                 continue;
             }
+            Logger::logError("Error reading packet: " + std::to_string(ret));
+            break;
+        }
+
+        SPSCRingBuffer<QueuedPacket>* queue = nullptr;
+        if (packet->stream_index == videoStreamIndex) {
+            trackClipBounds(packet);
+            queue = &videoPacketQueue;
+        } else if (packet->stream_index == audioStreamIndex && audioDecodingEnabled) {
+            queue = &audioPacketQueue;
+        }
+
+        if (!queue || !pushPacket(*queue, {packet, PacketMarker::None, loopOffsetSeconds, AV_NOPTS_VALUE, demuxGeneration})) {
+            av_packet_free(&packet);
         }
 
-        int ret = av_read_frame(formatContext, packet);
+        reportPipelineStats();
+    }
+
+    Logger::logInfo("Demux thread terminated");
+}
+
+void VideoDecoder::videoDecodeThreadFunction() {
+    AVFrame* frame = av_frame_alloc();
+    QueuedPacket entry;
+
+    Logger::logInfo("Starting video decode thread");
+    Tracer::setThreadName("video decode");
+    ThreadCpuScope cpuScope("video decode");
+    static Histogram& decodeTime = Metrics::histogram(Metrics::DECODE_TIME_US);
+
+    while (popPacket(videoPacketQueue, entry, videoDecodeStats)) {
+        if (!entry.packet) {
+            if (!handleVideoMarker(entry, frame)) {
+                break;
+            }
+            continue;
+        }
+
+        int degradation = requestedDegradation;
+        if (degradation != appliedDegradation) {
+            applyDegradation(codecContext, degradation);
+            appliedDegradation = degradation;
+            Logger::logInfo("Video decoder degradation level " + std::to_string(degradation));
+        }
+
+        LOG_DEBUG("Processing video packet - size: " + std::to_string(entry.packet->size) +
+                  ", pts: " + std::to_string(entry.packet->pts));
+
+        // Avec plusieurs threads, le décodeur peut refuser un paquet tant que ses frames
+        // n'ont pas été récupérées : on les vide puis on renvoie le paquet au lieu de le perdre
+        packetCodecTime = std::chrono::steady_clock::duration::zero();
+        int ret = sendVideoPacket(entry.packet);
+        while (ret == AVERROR(EAGAIN) && receiveVideoFrames(frame)) {
+            ret = sendVideoPacket(entry.packet);
+        }
+        av_packet_free(&entry.packet);
         if (ret < 0) {
-            if (ret == AVERROR_EOF) {
-                Logger::logInfo("End of file reached, seeking to start");
-                seekToStart();
-                continue;
+            if (!isRunning) {
+                break;
             }
+            Logger::logError("Error sending video packet: " + std::to_string(ret));
+            continue;
+        }
+
+        if (!receiveVideoFrames(frame)) {
             break;
         }
+        decodeTime.recordDuration(packetCodecTime);
+        reportCopyRate();
+    }
+
+    av_frame_free(&frame);
+    Logger::logInfo("Video decode thread terminated");
+}
+
+bool VideoDecoder::handleVideoMarker(const QueuedPacket& entry, AVFrame* frame) {
+    if (entry.marker == PacketMarker::Replay) {
+        loopCache.sealVideo();
+    }
+    if (entry.marker != PacketMarker::Flush) {
+        // Fin de l'itération : récupérer les frames encore retenues par le décodeur
+        avcodec_send_packet(codecContext, nullptr);
+        if (!receiveVideoFrames(frame)) {
+            return false;
+        }
+    }
+    avcodec_flush_buffers(codecContext);
+    if (entry.marker == PacketMarker::Flush) {
+        // Le cache doit couvrir le clip depuis son début
+        if (entry.seekPts == AV_NOPTS_VALUE) {
+            loopCache.restartVideo();
+        } else if (loopCache.isFilling()) {
+            loopCache.invalidate("seek during the first pass");
+        }
+    }
+
+    videoPtsOffset = toStreamTime(entry.ptsOffset, getVideoStream()->time_base);
+    videoDiscardBefore = entry.seekPts;
+    videoGeneration = entry.generation;
+    seekDiscardedFrames = 0;
+    nextVideoFrameStartsLoop = entry.marker != PacketMarker::Flush;
 
-        // Traiter d'abord quelques paquets audio avant de commencer la vidéo
-        if (video_frame_count == 0 && audio_frame_count < 5 && 
-            packet->stream_index == audioStreamIndex && audioCodecContext && audioManager) {
-            // Traitement des paquets audio initiaux
-            // ... code existant pour l'audio ...
-        }
-        // Traitement normal des paquets
-        else if (packet->stream_index == videoStreamIndex) {
-            Logger::logInfo("Processing video packet - size: " + std::to_string(packet->size) + 
-                          ", pts: " + std::to_string(packet->pts));
-            
-            ret = avcodec_send_packet(codecContext, packet);
-            if (ret < 0) {
-                Logger::logError("Error sending video packet: " + std::to_string(ret));
-                av_packet_unref(packet);
+    if (entry.marker == PacketMarker::Loop) {
+        // Enchaîner immédiatement sur le début pré-décodé ; le décodeur principal
+        // écarte ensuite ce que ces frames couvrent déjà
+        for (const AVFrame* standby : preroller.getVideoFrames()) {
+            AVFrame* queuedFrame = av_frame_clone(standby);
+            if (!queuedFrame) {
                 continue;
             }
+            queuedFrame->pts += videoPtsOffset;
+            if (!queueVideoFrame(queuedFrame)) {
+                av_frame_free(&queuedFrame);
+                return false;
+            }
+        }
+        videoDiscardBefore = preroller.getResumePts();
+    }
+
+    if (entry.marker == PacketMarker::Replay) {
+        loopCache.completeVideo();
+        if (loopCache.awaitCompletion(isRunning)) {
+            return replayVideoFromCache(entry.ptsOffset);
+        }
+        // Cache abandonné : le démultiplexeur reprend la lecture au début du fichier
+    }
+    return true;
+}
+
+bool VideoDecoder::replayVideoFromCache(double ptsOffset) {
+    AVRational timeBase = getVideoStream()->time_base;
+    for (uint64_t iteration = 0; isRunning; iteration++) {
+        double iterationOffset = ptsOffset + iteration * loopCache.getClipSeconds();
+        replayOffsetSeconds = iterationOffset;
+        int64_t offset = toStreamTime(iterationOffset, timeBase);
+        for (size_t i = 0; i < loopCache.getVideoFrameCount(); i++) {
+            // Un marqueur en attente (seek) interrompt la relecture
+            if (!videoPacketQueue.empty()) {
+                return true;
+            }
 
-            while (ret >= 0) {
-                ret = avcodec_receive_frame(codecContext, frame);
-                if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                    break;
-                }
-                if (ret < 0) {
-                    Logger::logError("Error receiving video frame: " + std::to_string(ret));
-                    break;
-                }
-
-                // Vérification plus stricte des buffers vidéo
-                if (!frame || !frame->data[0] || !frame->buf[0]) {
-                    Logger::logError("Invalid video frame data - skipping");
-                    continue;
-                }
-
-                Logger::logInfo("Creating video frame copy...");
-                
-                // Utiliser av_frame_alloc et av_frame_ref au lieu de av_frame_clone
-                AVFrame* frame_copy = av_frame_alloc();
-                if (!frame_copy) {
-                    Logger::logError("Failed to allocate video frame");
-                    continue;
-                }
-
-                // Copier les propriétés de base avant av_frame_ref
-                frame_copy->format = frame->format;
-                frame_copy->width = frame->width;
-                frame_copy->height = frame->height;
-
-                ret = av_frame_get_buffer(frame_copy, 32);
-                if (ret < 0) {
-                    Logger::logError("Failed to allocate frame buffers");
-                    av_frame_free(&frame_copy);
-                    continue;
-                }
-
-                ret = av_frame_copy(frame_copy, frame);
-                if (ret < 0) {
-                    Logger::logError("Failed to copy frame data");
-                    av_frame_free(&frame_copy);
-                    continue;
-                }
-
-                ret = av_frame_copy_props(frame_copy, frame);
-                if (ret < 0) {
-                    Logger::logError("Failed to copy frame properties");
-                    av_frame_free(&frame_copy);
-                    continue;
-                }
-
-                Logger::logInfo("Video frame copy created successfully");
-
-                {
-                    std::unique_lock<std::mutex> lock(mutex);
-                    frameQueue.push(frame_copy);
-                    condition.notify_one();
-                    Logger::logInfo("Video frame " + std::to_string(video_frame_count++) + " queued");
-                }
+            AVFrame* cachedFrame = loopCache.replayVideoFrame(i);
+            if (!cachedFrame) {
+                continue;
+            }
+            cachedFrame->pts += offset;
+            if (!queueVideoFrame(cachedFrame)) {
+                av_frame_free(&cachedFrame);
+                return false;
             }
         }
-        // Traitement des paquets audio
-        else if (packet->stream_index == audioStreamIndex && audioCodecContext && audioManager) {
-            Logger::logInfo("Processing audio packet - size: " + std::to_string(packet->size) + 
-                          ", pts: " + std::to_string(packet->pts));
-            
-            ret = avcodec_send_packet(audioCodecContext, packet);
-            if (ret < 0) {
-                Logger::logError("Error sending audio packet: " + std::to_string(ret));
-                av_packet_unref(packet);
+        nextVideoFrameStartsLoop = true;
+        reportCopyRate();
+    }
+    return false;
+}
+
+int VideoDecoder::sendVideoPacket(AVPacket* packet) {
+    TraceScope span("decode video packet", packet->pts);
+    auto start = std::chrono::steady_clock::now();
+    int ret = avcodec_send_packet(codecContext, packet);
+    packetCodecTime += std::chrono::steady_clock::now() - start;
+    return ret;
+}
+
+bool VideoDecoder::receiveVideoFrames(AVFrame* frame) {
+    while (true) {
+        int ret;
+        {
+            TraceScope span("receive video frame");
+            auto start = std::chrono::steady_clock::now();
+            ret = avcodec_receive_frame(codecContext, frame);
+            packetCodecTime += std::chrono::steady_clock::now() - start;
+            span.setPts(ret < 0 ? Tracer::NO_PTS : frame->pts);
+        }
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            return true;
+        }
+        if (ret < 0) {
+            Logger::logError("Error receiving video frame: " + std::to_string(ret));
+            return true;
+        }
+
+        if (!frame->data[0]) {
+            Logger::logError("Invalid video frame data - skipping");
+            av_frame_unref(frame);
+            continue;
+        }
+
+        if (videoDiscardBefore != AV_NOPTS_VALUE && frame->pts != AV_NOPTS_VALUE) {
+            if (frame->pts < videoDiscardBefore) {
+                // Antérieure à la cible du seek, ou déjà présentée depuis le tampon pré-décodé
+                av_frame_unref(frame);
+                seekDiscardedFrames++;
                 continue;
             }
+            videoDiscardBefore = AV_NOPTS_VALUE;
+        }
+        // Réduite avant le cache et la file : seuls les pixels affichables sont conservés
+        {
+            TraceScope span("downscale", frame->pts);
+            scaler.scale(frame);
+        }
+        if (appliedDegradation > 0) {
+            degradedFrames++;
+        }
+        if (config.loopMode == LoopMode::Cache && loopCache.isFilling()) {
+            // Un cache dégradé serait rejoué dégradé à chaque boucle
+            if (appliedDegradation > 0) {
+                loopCache.invalidate("decoder degraded during the first pass");
+            } else {
+                loopCache.storeVideoFrame(frame);
+            }
+        }
+        if (frame->pts != AV_NOPTS_VALUE) {
+            frame->pts += videoPtsOffset;
+        }
 
-            while (ret >= 0) {
-                ret = avcodec_receive_frame(audioCodecContext, frame);
-                if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                    break;
-                }
-                if (ret < 0) {
-                    Logger::logError("Error receiving audio frame: " + std::to_string(ret));
-                    break;
-                }
-
-                Logger::logInfo("Cloning audio frame " + std::to_string(audio_frame_count));
-                AVFrame* frame_copy = av_frame_clone(frame);
-                if (!frame_copy) {
-                    Logger::logError("Failed to clone audio frame");
-                    continue;
-                }
-
-                // Gérer le PTS négatif
-                if (frame_copy->pts < 0 || frame_copy->pts == AV_NOPTS_VALUE) {
-                    frame_copy->pts = audio_frame_count * frame_copy->nb_samples;
-                    Logger::logInfo("Corrected audio PTS: " + std::to_string(frame_copy->pts));
-                }
-
-                Logger::logInfo("Pushing audio frame " + std::to_string(audio_frame_count));
-                audioManager->pushFrame(frame_copy);
-                Logger::logInfo("Audio frame " + std::to_string(audio_frame_count++) + " pushed");
+        // Transférer la référence du buffer pool du décodeur, sans copie des pixels.
+        // Le Renderer libère la frame une fois la texture mise à jour.
+        AVFrame* queuedFrame = av_frame_alloc();
+        if (!queuedFrame) {
+            Logger::logError("Failed to allocate video frame");
+            av_frame_unref(frame);
+            continue;
+        }
+
+        if (frame->buf[0]) {
+            av_frame_move_ref(queuedFrame, frame);
+        } else {
+            // Frame non refcountée : av_frame_ref doit dupliquer les données
+            TraceScope span("copy video frame", frame->pts);
+            int err = av_frame_ref(queuedFrame, frame);
+            av_frame_unref(frame);
+            if (err < 0) {
+                Logger::logError("Failed to reference video frame");
+                av_frame_free(&queuedFrame);
+                continue;
             }
+            copiedBytes += av_image_get_buffer_size(
+                static_cast<AVPixelFormat>(queuedFrame->format),
+                queuedFrame->width, queuedFrame->height, 1);
+        }
+
+        if (!queueVideoFrame(queuedFrame)) {
+            av_frame_free(&queuedFrame);
+            return false;
         }
+        LOG_DEBUG_EVERY(1000, "Video frame " + std::to_string(videoFrameCount) + " queued");
+        videoFrameCount++;
+    }
+}
+
+bool VideoDecoder::queueVideoFrame(AVFrame* frame) {
+    TraceScope span("queue video frame", frame->pts);
+    // Bloque tant que le budget mémoire/durée ou la file est plein (contre-pression sur le décodage)
+    auto start = std::chrono::steady_clock::now();
+    while (isRunning && !videoBudget.waitForRoom(std::chrono::milliseconds(100))) {
+    }
 
-        av_packet_unref(packet);
+    QueuedFrame entry{frame, frameMemorySize(frame), std::chrono::steady_clock::now(),
+                      nextVideoFrameStartsLoop, videoGeneration};
+    nextVideoFrameStartsLoop = false;
+    videoBudget.add(entry.bytes, frameDuration);
+    while (isRunning && !frameQueue.waitPush(entry, std::chrono::milliseconds(100))) {
+    }
+    if (startupWaiting) {
+        std::lock_guard<std::mutex> lock(startupMutex);
+        startupCondition.notify_all();
+    }
+
+    videoDecodeStats.blockedUs += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return isRunning;
+}
+
+void VideoDecoder::audioDecodeThreadFunction() {
+    AVFrame* frame = av_frame_alloc();
+    QueuedPacket entry;
+
+    Logger::logInfo("Starting audio decode thread");
+    Tracer::setThreadName("audio decode");
+    ThreadCpuScope cpuScope("audio decode");
+
+    while (popPacket(audioPacketQueue, entry, audioDecodeStats)) {
+        if (!entry.packet) {
+            handleAudioMarker(entry, frame);
+            continue;
+        }
+
+        LOG_DEBUG("Processing audio packet - size: " + std::to_string(entry.packet->size) +
+                  ", pts: " + std::to_string(entry.packet->pts));
+
+        int ret;
+        {
+            TraceScope span("decode audio packet", entry.packet->pts);
+            ret = avcodec_send_packet(audioCodecContext, entry.packet);
+        }
+        // Décodeur plein : le vider avant de renvoyer le paquet, sauf si l'arrêt bloque la sortie
+        while (ret == AVERROR(EAGAIN) && receiveAudioFrames(frame)) {
+            ret = avcodec_send_packet(audioCodecContext, entry.packet);
+        }
+        av_packet_free(&entry.packet);
+        if (ret < 0) {
+            Logger::logError("Error sending audio packet: " + std::to_string(ret));
+            continue;
+        }
+
+        receiveAudioFrames(frame);
     }
 
     av_frame_free(&frame);
-    av_packet_free(&packet);
-    Logger::logInfo("Decode thread terminated");
-}
\ No newline at end of file
+    Logger::logInfo("Audio decode thread terminated");
+}
+
+void VideoDecoder::handleAudioMarker(const QueuedPacket& entry, AVFrame* frame) {
+    if (entry.marker == PacketMarker::Replay) {
+        loopCache.sealAudio();
+    }
+    if (entry.marker != PacketMarker::Flush) {
+        avcodec_send_packet(audioCodecContext, nullptr);
+        receiveAudioFrames(frame);
+    }
+    avcodec_flush_buffers(audioCodecContext);
+    AVRational audioTimeBase = getAudioStream()->time_base;
+    audioDiscardBefore = AV_NOPTS_VALUE;
+    if (entry.marker == PacketMarker::Flush) {
+        // L'audio déjà en file précède le seek
+        audioManager->flush();
+        if (entry.seekPts == AV_NOPTS_VALUE) {
+            loopCache.restartAudio();
+        } else {
+            audioDiscardBefore = av_rescale_q(entry.seekPts, getVideoStream()->time_base, audioTimeBase);
+        }
+    }
+
+    audioPtsOffset = toStreamTime(entry.ptsOffset, audioTimeBase);
+
+    if (entry.marker == PacketMarker::Loop) {
+        for (const AVFrame* standby : preroller.getAudioFrames()) {
+            AVFrame* audioFrame = av_frame_clone(standby);
+            if (!audioFrame) {
+                continue;
+            }
+            audioFrame->pts += audioPtsOffset;
+            if (!pushAudioFrame(audioFrame)) {
+                return;
+            }
+        }
+        audioDiscardBefore = av_rescale_q(preroller.getResumePts(), getVideoStream()->time_base, audioTimeBase);
+    }
+
+    if (entry.marker == PacketMarker::Replay) {
+        loopCache.completeAudio();
+        if (loopCache.awaitCompletion(isRunning)) {
+            replayAudioFromCache(entry.ptsOffset);
+        }
+    }
+}
+
+void VideoDecoder::replayAudioFromCache(double ptsOffset) {
+    AVRational timeBase = getAudioStream()->time_base;
+    for (uint64_t iteration = 0; isRunning; iteration++) {
+        int64_t offset = toStreamTime(ptsOffset + iteration * loopCache.getClipSeconds(), timeBase);
+        for (const AVFrame* cached : loopCache.getAudioFrames()) {
+            if (!audioPacketQueue.empty()) {
+                return;
+            }
+
+            AVFrame* audioFrame = av_frame_clone(cached);
+            if (!audioFrame) {
+                continue;
+            }
+            audioFrame->pts += offset;
+            if (!pushAudioFrame(audioFrame)) {
+                return;
+            }
+        }
+    }
+}
+
+bool VideoDecoder::pushAudioFrame(AVFrame* frame) {
+    auto start = std::chrono::steady_clock::now();
+    while (isRunning && !audioManager->waitForQueueRoom(std::chrono::milliseconds(100))) {
+    }
+    audioDecodeStats.blockedUs += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    if (!isRunning) {
+        av_frame_free(&frame);
+        return false;
+    }
+
+    audioManager->pushFrame(frame);
+    return true;
+}
+
+bool VideoDecoder::receiveAudioFrames(AVFrame* frame) {
+    while (true) {
+        int ret = avcodec_receive_frame(audioCodecContext, frame);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            return isRunning;
+        }
+        if (ret < 0) {
+            Logger::logError("Error receiving audio frame: " + std::to_string(ret));
+            return isRunning;
+        }
+
+        AVFrame* frame_copy = av_frame_clone(frame);
+        av_frame_unref(frame);
+        if (!frame_copy) {
+            Logger::logError("Failed to clone audio frame");
+            continue;
+        }
+
+        // Gérer le PTS négatif
+        if (frame_copy->pts < 0 || frame_copy->pts == AV_NOPTS_VALUE) {
+            frame_copy->pts = audioFrameCount * frame_copy->nb_samples;
+            LOG_DEBUG_EVERY(1000, "Corrected audio PTS: " + std::to_string(frame_copy->pts));
+        }
+
+        if (audioDiscardBefore != AV_NOPTS_VALUE) {
+            if (frame_copy->pts < audioDiscardBefore) {
+                av_frame_free(&frame_copy);  // déjà jouée depuis le tampon pré-décodé
+                continue;
+            }
+            audioDiscardBefore = AV_NOPTS_VALUE;
+        }
+        if (config.loopMode == LoopMode::Cache && loopCache.isFilling()) {
+            loopCache.storeAudioFrame(frame_copy);
+        }
+        frame_copy->pts += audioPtsOffset;
+
+        if (!pushAudioFrame(frame_copy)) {
+            return false;
+        }
+        LOG_DEBUG_EVERY(1000, "Audio frame " + std::to_string(audioFrameCount) + " pushed");
+        audioFrameCount++;
+    }
+}
@@ -1,9 +1,16 @@
 #pragma once
 #include <string>
 #include <thread>
-#include <queue>
-#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <mutex>
+#include "../utils/SPSCRingBuffer.h"
+#include "DecoderConfig.h"
+#include "LoopPreroller.h"
+#include "LoopCache.h"
+#include "KeyframeIndex.h"
+#include "FrameScaler.h"
 
 extern "C" {
     #include <libavcodec/avcodec.h>
@@ -11,16 +18,60 @@ extern "C" {
 }
 
 class AudioManager;  // Forward declaration
+class StartupTimeline;
 
 class VideoDecoder {
 public:
+    // Répartition du temps d'un étage du pipeline sur la dernière seconde
+    struct StageOccupancy {
+        double busyPercent;
+        double blockedPercent;   // en attente d'une place dans la file de sortie
+        double starvedPercent;   // en attente d'une entrée
+    };
+
+    struct PipelineStats {
+        size_t videoPackets;
+        size_t videoPacketCapacity;
+        size_t audioPackets;
+        size_t audioPacketCapacity;
+        size_t videoFrames;
+        size_t videoFrameCapacity;
+        size_t videoQueueBytes;
+        double videoQueueSeconds;
+        uint64_t audioUnderruns;
+        size_t audioQueueBytes;
+        double audioQueueSeconds;
+        StageOccupancy demux;
+        StageOccupancy videoDecode;
+        StageOccupancy audioDecode;
+        double processCpuPercent;   // temps CPU du processus, 100% = un cœur
+    };
+
+    // Transitions de boucle mesurées côté consommateur
+    struct LoopStats {
+        uint64_t loops;
+        double lastBoundaryGapMs;   // écart entre la dernière frame d'une boucle et la première de la suivante
+        double maxBoundaryGapMs;
+        double averageFrameGapMs;   // écart moyen entre frames pendant la boucle précédente
+    };
+
     VideoDecoder();
     ~VideoDecoder();
 
-    bool initialize(const std::string& path);
+    void setConfig(const DecoderConfig& decoderConfig) { config = decoderConfig; }
+    const DecoderConfig& getConfig() const { return config; }
+    // Taille maximale des frames mises en file (--downscale), à fixer avant startDecoding
+    void setDownscaleSize(int width, int height) { config.downscaleWidth = width; config.downscaleHeight = height; }
+    // Taille des frames mises en file une fois la réduction appliquée
+    void getOutputSize(int& width, int& height) const;
+    // timeline : reçoit la durée de chaque étape de l'ouverture, si fournie
+    bool initialize(const std::string& path, StartupTimeline* timeline = nullptr);
     void startDecoding();
     void stopDecoding();
-    AVFrame* getNextFrame();
+    // Sans délai : retourne immédiatement. Avec délai : dort jusqu'à ce qu'une frame soit prête.
+    AVFrame* getNextFrame(std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+    // Attend que MIN_FRAMES_TO_START frames soient prêtes (ou que le budget de la file soit atteint)
+    bool waitForStartupFrames(std::chrono::milliseconds timeout);
     
     AVCodecContext* getCodecContext() const { return codecContext; }
     AVStream* getVideoStream() const;
@@ -28,15 +79,40 @@ public:
     AVCodecContext* getAudioCodecContext() const { return audioCodecContext; }
     void setAudioManager(AudioManager* am) { audioManager = am; }
 
-    void seekToStart() {
-        if (formatContext) {
-            av_seek_frame(formatContext, -1, 0, AVSEEK_FLAG_BACKWARD);
-            avcodec_flush_buffers(codecContext);
-            if (audioCodecContext) {
-                avcodec_flush_buffers(audioCodecContext);
-            }
-        }
-    }
+    // Octets de pixels copiés par seconde entre le décodeur et la file (0 en zero-copy)
+    uint64_t getCopiedBytesPerSecond() const { return copiedBytesPerSecond; }
+    // Latence moyenne entre la mise en file d'une frame et son retrait par le Renderer
+    uint64_t getAverageQueueLatencyUs() const { return averageQueueLatencyUs; }
+    PipelineStats getPipelineStats() const;
+    LoopStats getLoopStats() const;
+    LoopCache::Stats getLoopCacheStats() const { return loopCache.getStats(); }
+
+    // Le seek est exécuté par le thread de démultiplexage, qui signale ensuite
+    // la discontinuité aux threads de décodage. Les frames déjà en file sont écartées.
+    void seekToStart() { requestSeek(AV_NOPTS_VALUE); }
+    // Saute à la keyframe précédant la cible puis décode en écartant les frames antérieures
+    void seekTo(double seconds);
+    // Numéro de frame dans l'ordre de présentation ; approximé par la cadence tant que l'index n'est pas prêt
+    void seekToFrame(int64_t frameNumber);
+    // Délai entre la dernière demande de seek et la première frame rendue à la position demandée
+    uint64_t getLastSeekLatencyUs() const { return lastSeekLatencyUs; }
+    const KeyframeIndex& getKeyframeIndex() const { return keyframeIndex; }
+    // Vrai une seule fois après la première frame qui suit un seek : l'horloge de présentation doit être réancrée
+    bool consumeDiscontinuity() { return discontinuity.exchange(false); }
+
+    double getFrameDuration() const { return frameDuration; }
+    // Niveau 0 : décodage complet. Appliqué par le thread de décodage vidéo avant le paquet suivant.
+    void setDegradationLevel(int level) { requestedDegradation = level; }
+    uint64_t getDegradedFrameCount() const { return degradedFrames; }
+    static void applyDegradation(AVCodecContext* context, int level);
+
+    static const char* threadingName(DecoderThreading threading);
+    static bool parseThreading(const std::string& name, DecoderThreading& threading);
+    static const char* loopModeName(LoopMode mode);
+    static bool parseLoopMode(const std::string& name, LoopMode& mode);
+    static void configureThreading(AVCodecContext* context, const DecoderConfig& config);
+    // Mémoire réellement référencée par une frame (buffers refcountés)
+    static size_t frameMemorySize(const AVFrame* frame);
 
     void reset() {
         flushBuffers();
@@ -44,8 +120,74 @@ public:
     }
 
 private:
-    void decodeThreadFunction();
+    struct QueuedFrame {
+        AVFrame* frame;
+        size_t bytes;
+        std::chrono::steady_clock::time_point enqueuedAt;
+        bool loopStart;
+        uint64_t generation;   // numéro du seek qui a produit la frame
+    };
+
+    // Discontinuités transmises sans paquet dans les files de paquets
+    enum class PacketMarker {
+        None,
+        Flush,        // seek demandé : les frames en cours sont abandonnées
+        EndOfStream,  // fin du fichier : le décodeur rend ses dernières frames puis repart du début
+        Loop,         // idem en mode Gapless, puis enchaîne sur le début pré-décodé
+        Replay        // idem en mode Cache, puis rejoue les boucles depuis le cache tant qu'il est valide
+    };
+
+    // ptsOffset : décalage cumulé des boucles, en secondes, appliqué aux frames qui suivent.
+    // seekPts : pour un Flush, frames antérieures à écarter (AV_NOPTS_VALUE : début du fichier)
+    struct QueuedPacket {
+        AVPacket* packet;
+        PacketMarker marker;
+        double ptsOffset;
+        int64_t seekPts;
+        uint64_t generation;
+    };
+
+    struct StageStats {
+        std::atomic<uint64_t> blockedUs{0};
+        std::atomic<uint64_t> starvedUs{0};
+        std::atomic<double> blockedPercent{0.0};
+        std::atomic<double> starvedPercent{0.0};
+
+        StageOccupancy occupancy() const;
+    };
+
+    void demuxThreadFunction();
+    void videoDecodeThreadFunction();
+    void audioDecodeThreadFunction();
+    void loopToStart();
+    void pushMarker(PacketMarker marker, int64_t seekPts = AV_NOPTS_VALUE);
+    void requestSeek(int64_t targetPts);
+    void performSeek();
+    void reportSeekLatency();
+    void trackClipBounds(const AVPacket* packet);
+    void idleWhileReplaying();
+    bool replayVideoFromCache(double ptsOffset);
+    void replayAudioFromCache(double ptsOffset);
+    void updateCpuUsage(double elapsedUs);
+    bool handleVideoMarker(const QueuedPacket& entry, AVFrame* frame);
+    void handleAudioMarker(const QueuedPacket& entry, AVFrame* frame);
+    bool pushAudioFrame(AVFrame* frame);
+    void recordFrameGap(const QueuedFrame& entry);
+    bool pushPacket(SPSCRingBuffer<QueuedPacket>& queue, const QueuedPacket& entry);
+    bool popPacket(SPSCRingBuffer<QueuedPacket>& queue, QueuedPacket& entry, StageStats& stats);
+    // avcodec_send_packet, tracé ; son temps s'ajoute à packetCodecTime comme celui des réceptions
+    int sendVideoPacket(AVPacket* packet);
+    bool receiveVideoFrames(AVFrame* frame);
+    bool queueVideoFrame(AVFrame* frame);
+    // false quand le décodage s'arrête : les frames ne peuvent plus être remises à l'audio
+    bool receiveAudioFrames(AVFrame* frame);
+    void reportCopyRate();
+    void reportPipelineStats();
+    void recordQueueLatency(std::chrono::steady_clock::time_point enqueuedAt);
+    bool startupFramesReady() const;
     
+    DecoderConfig config;
+    std::string videoPath;
     AVFormatContext* formatContext;
     AVCodecContext* codecContext;
     AVCodecContext* audioCodecContext;
@@ -53,13 +195,93 @@ private:
     int audioStreamIndex;
     AudioManager* audioManager;
     
-    std::thread decodeThread;
-    std::queue<AVFrame*> frameQueue;
-    std::mutex mutex;
-    std::condition_variable condition;
-    bool isRunning;
+    std::thread demuxThread;
+    std::thread videoDecodeThread;
+    std::thread audioDecodeThread;
+    SPSCRingBuffer<QueuedPacket> videoPacketQueue;
+    SPSCRingBuffer<QueuedPacket> audioPacketQueue;
+    SPSCRingBuffer<QueuedFrame> frameQueue;
+    QueueBudget videoBudget;
+    double frameDuration;
+    std::atomic<bool> isRunning;
+    std::atomic<bool> seekRequested;
+    std::atomic<bool> startupWaiting;
+    std::mutex startupMutex;
+    std::condition_variable startupCondition;
+    std::atomic<int64_t> seekTargetPts;
+    std::atomic<uint64_t> seekGeneration;
+    std::atomic<int64_t> seekRequestedAtNs;
+    KeyframeIndex keyframeIndex;
+    bool audioDecodingEnabled;
+
+    uint64_t videoFrameCount;
+    uint64_t audioFrameCount;
+
+    // Bouclage : bornes du clip et décalage cumulé (thread de démultiplexage)
+    LoopPreroller preroller;
+    // Utilisé uniquement par le thread de décodage vidéo
+    FrameScaler scaler;
+    // Temps passé dans le décodeur pour le paquet courant, envoi et réceptions compris :
+    // avec le multithreading par frame, le décodage se fait surtout dans avcodec_receive_frame
+    std::chrono::steady_clock::duration packetCodecTime{};
+    int64_t clipStartPts;
+    int64_t clipEndPts;
+    double loopOffsetSeconds;
+    // Décalage de la boucle relue depuis le cache (écrit par le thread de décodage vidéo)
+    std::atomic<double> replayOffsetSeconds;
+    LoopCache loopCache;
+    bool replayingFromCache;
+    uint64_t demuxGeneration;
+
+    // État de rebasage propre à chaque thread de décodage, en time base du flux
+    int64_t videoPtsOffset;
+    int64_t videoDiscardBefore;
+    bool nextVideoFrameStartsLoop;
+    int64_t audioPtsOffset;
+    int64_t audioDiscardBefore;
+    uint64_t videoGeneration;
+    std::atomic<uint64_t> seekDiscardedFrames;
+
+    // Mesure des transitions de boucle (consommateur)
+    std::chrono::steady_clock::time_point lastDequeueTime;
+    int64_t lastDequeuedPts;
+    uint64_t frameGapSumUs;
+    uint64_t frameGapCount;
+    std::atomic<uint64_t> loopCount;
+    std::atomic<uint64_t> lastLoopGapUs;
+    std::atomic<uint64_t> maxLoopGapUs;
+    std::atomic<uint64_t> averageFrameGapUs;
+    uint64_t presentedGeneration;
+    std::atomic<uint64_t> lastSeekLatencyUs;
+    std::atomic<bool> discontinuity;
+
+    // Dégradation demandée par le consommateur, appliquée par le thread de décodage vidéo
+    std::atomic<int> requestedDegradation;
+    int appliedDegradation;
+    std::atomic<uint64_t> degradedFrames;
+
+    StageStats demuxStats;
+    StageStats videoDecodeStats;
+    StageStats audioDecodeStats;
+    std::chrono::steady_clock::time_point lastPipelineReport;
+    uint64_t lastCpuTimeUs;
+    std::atomic<double> processCpuPercent;
+
+    std::atomic<uint64_t> copiedBytes;
+    std::atomic<uint64_t> copiedBytesPerSecond;
+    std::chrono::steady_clock::time_point lastCopyReport;
+
+    // Statistiques de latence de la file, mises à jour par le consommateur uniquement
+    uint64_t queueLatencySumUs;
+    uint64_t queueLatencyMaxUs;
+    uint64_t queueLatencySamples;
+    std::atomic<uint64_t> averageQueueLatencyUs;
+    std::chrono::steady_clock::time_point lastLatencyReport;
     
-    static constexpr size_t MAX_QUEUE_SIZE = 30;
+    // Plafond en nombre de frames ; la limite effective est le budget videoQueue
+    static constexpr size_t MAX_QUEUED_FRAMES = 256;
+    static constexpr size_t VIDEO_PACKET_QUEUE_SIZE = 64;
+    static constexpr size_t AUDIO_PACKET_QUEUE_SIZE = 256;
     static constexpr size_t MIN_FRAMES_TO_START = 5;
 
     void flushBuffers() {
@@ -0,0 +1,323 @@
+#include "VideoWall.h"
+#include "../utils/Logger.h"
+#include "../utils/Metrics.h"
+#include "../utils/Tracer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+VideoWall::VideoWall(RendererBackend backend, const RendererOptions& options, const WallConfig& config)
+    : outputBackend(backend)
+    , outputOptions(options)
+    , config(config)
+    , generation(0)
+    , pendingOutputs(0)
+    , stopping(false)
+    , preparedSource(nullptr)
+    , windowFrames(0)
+    , windowSkewMs(0.0)
+    , maxSkewMs(0.0) {
+}
+
+VideoWall::~VideoWall() {
+    cleanup();
+}
+
+bool VideoWall::parseGrid(const std::string& value, int& columns, int& rows) {
+    size_t separator = value.find('x');
+    if (separator == std::string::npos) {
+        return false;
+    }
+    columns = std::atoi(value.substr(0, separator).c_str());
+    rows = std::atoi(value.substr(separator + 1).c_str());
+    return columns > 0 && rows > 0;
+}
+
+bool VideoWall::parseTile(const std::string& value, WallTile& tile) {
+    char separator = 0;
+    int consumed = 0;
+    if (sscanf(value.c_str(), "%d:%d,%d,%d%c%d%n", &tile.display, &tile.x, &tile.y, &tile.width, &separator,
+               &tile.height, &consumed) != 6) {
+        return false;
+    }
+    return separator == 'x' && consumed == static_cast<int>(value.size()) && tile.display >= 0 &&
+           tile.x >= 0 && tile.y >= 0 && tile.width > 0 && tile.height > 0;
+}
+
+std::vector<WallTile> VideoWall::gridTiles(int columns, int rows, int width, int height) {
+    std::vector<WallTile> tiles;
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            // Bords pairs : les plans de chrominance 4:2:0 se découpent sur les mêmes limites
+            int left = (width * column / columns) & ~1;
+            int right = column + 1 == columns ? width : (width * (column + 1) / columns) & ~1;
+            int top = (height * row / rows) & ~1;
+            int bottom = row + 1 == rows ? height : (height * (row + 1) / rows) & ~1;
+
+            WallTile tile;
+            tile.display = static_cast<int>(tiles.size());
+            tile.x = left;
+            tile.y = top;
+            tile.width = right - left;
+            tile.height = bottom - top;
+            tiles.push_back(tile);
+        }
+    }
+    return tiles;
+}
+
+bool VideoWall::initialize(int width, int height) {
+    std::vector<WallTile> tiles = config.tiles.empty()
+        ? gridTiles(std::max(1, config.columns), std::max(1, config.rows), width, height)
+        : config.tiles;
+
+    for (WallTile tile : tiles) {
+        // Origine paire, rectangle borné à la frame
+        tile.x = std::min(tile.x & ~1, width);
+        tile.y = std::min(tile.y & ~1, height);
+        tile.width = std::min(tile.width, width - tile.x);
+        tile.height = std::min(tile.height, height - tile.y);
+        if (tile.width <= 0 || tile.height <= 0) {
+            Logger::logError("Wall tile for display " + std::to_string(tile.display) + " is outside the " +
+                             std::to_string(width) + "x" + std::to_string(height) + " frame");
+            cleanup();
+            return false;
+        }
+
+        std::unique_ptr<Output> output(new Output());
+        output->tile = tile;
+        output->view = nullptr;
+        output->pendingPrepare = nullptr;
+        output->renderPrepared = false;
+        output->abandonRequested = false;
+        std::promise<bool> promise;
+        std::future<bool> ready = promise.get_future();
+        output->thread = std::thread(&VideoWall::outputThreadFunction, this, std::ref(*output), std::move(promise));
+        Logger::logInfo("Wall output " + std::to_string(outputs.size()) + ": display " +
+                        std::to_string(tile.display) + ", " + std::to_string(tile.width) + "x" +
+                        std::to_string(tile.height) + " at " + std::to_string(tile.x) + "," + std::to_string(tile.y));
+        outputs.push_back(std::move(output));
+
+        // Le sous-système vidéo de SDL n'est pas thread-safe : les sorties créent leur fenêtre
+        // et leur rendu l'une après l'autre, seule la présentation se fait en parallèle
+        if (!ready.get()) {
+            Logger::logError("Failed to initialize every wall output");
+            cleanup();
+            return false;
+        }
+    }
+    lastReport = Clock::now();
+    return true;
+}
+
+void VideoWall::outputThreadFunction(Output& output, std::promise<bool> ready) {
+    // Chaque sortie crée et utilise son rendu sur son propre thread : les présentations
+    // bloquées par la vsync de chaque écran se font en parallèle
+    Tracer::setThreadName("wall output " + std::to_string(output.tile.display));
+    ThreadCpuScope cpuScope("wall output " + std::to_string(output.tile.display));
+    RendererOptions options = outputOptions;
+    options.displayIndex = output.tile.display;
+    output.renderer = Renderer::create(outputBackend, options);
+    bool initialized = output.renderer->initialize(output.tile.width, output.tile.height);
+    ready.set_value(initialized);
+    if (!initialized) {
+        output.renderer->cleanup();
+        return;
+    }
+
+    // Vue confiée à prepareFrame() du rendu de la sortie, gardée jusqu'à son rendu ou son abandon
+    AVFrame* preparedView = nullptr;
+    auto dropPrepared = [&]() {
+        if (preparedView) {
+            output.renderer->abandonPrepared();
+            av_frame_free(&preparedView);
+        }
+    };
+
+    uint64_t presentedGeneration = 0;
+    while (true) {
+        AVFrame* view = nullptr;
+        AVFrame* prepare;
+        bool abandon;
+        bool render = false;
+        bool usePrepared = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameReady.wait(lock, [&]() {
+                return stopping || generation != presentedGeneration || output.pendingPrepare || output.abandonRequested;
+            });
+            if (stopping) {
+                break;
+            }
+            abandon = output.abandonRequested;
+            output.abandonRequested = false;
+            prepare = output.pendingPrepare;
+            output.pendingPrepare = nullptr;
+            if (generation != presentedGeneration) {
+                presentedGeneration = generation;
+                render = true;
+                view = output.view;
+                output.view = nullptr;
+                usePrepared = output.renderPrepared;
+            }
+        }
+
+        // Dans l'ordre des demandes : abandon, préparation de la frame suivante, rendu
+        if (abandon || prepare) {
+            dropPrepared();
+        }
+        if (prepare) {
+            output.renderer->prepareFrame(prepare);
+            preparedView = prepare;
+        }
+        if (!render) {
+            continue;
+        }
+        if (usePrepared) {
+            view = preparedView;
+            preparedView = nullptr;
+        } else {
+            dropPrepared();
+        }
+
+        output.renderer->renderFrame(view);
+        av_frame_free(&view);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        output.presentedAt = Clock::now();
+        if (--pendingOutputs == 0) {
+            frameDone.notify_one();
+        }
+    }
+
+    dropPrepared();
+    output.renderer->cleanup();
+}
+
+AVFrame* VideoWall::cropView(const AVFrame* frame, const WallTile& tile) {
+    if (tile.x + tile.width > frame->width || tile.y + tile.height > frame->height) {
+        return nullptr;
+    }
+
+    // Nouvelle référence sur les buffers de la frame : le recadrage ne déplace que les pointeurs de plans
+    AVFrame* view = av_frame_clone(frame);
+    if (!view) {
+        return nullptr;
+    }
+    view->crop_left = tile.x;
+    view->crop_top = tile.y;
+    view->crop_right = frame->width - tile.x - tile.width;
+    view->crop_bottom = frame->height - tile.y - tile.height;
+    if (av_frame_apply_cropping(view, AV_FRAME_CROP_UNALIGNED) < 0) {
+        av_frame_free(&view);
+    }
+    return view;
+}
+
+void VideoWall::prepareFrame(const AVFrame* frame) {
+    if (!frame || outputs.empty() || frame == preparedSource) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Une préparation pas encore reprise est remplacée ; les sorties abandonnent la précédente
+        for (std::unique_ptr<Output>& output : outputs) {
+            av_frame_free(&output->pendingPrepare);
+            output->pendingPrepare = cropView(frame, output->tile);
+        }
+        preparedSource = frame;
+    }
+    frameReady.notify_all();
+}
+
+void VideoWall::abandonPrepared() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!preparedSource) {
+            return;
+        }
+        preparedSource = nullptr;
+        for (std::unique_ptr<Output>& output : outputs) {
+            av_frame_free(&output->pendingPrepare);
+            output->abandonRequested = true;
+        }
+    }
+    frameReady.notify_all();
+}
+
+void VideoWall::renderFrame(AVFrame* frame) {
+    if (!frame || outputs.empty()) return;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // Frame préparée : chaque sortie rend la vue qu'elle a déjà commencé à écrire
+        bool prepared = frame == preparedSource;
+        preparedSource = nullptr;
+        for (std::unique_ptr<Output>& output : outputs) {
+            output->view = prepared ? nullptr : cropView(frame, output->tile);
+            output->renderPrepared = prepared;
+        }
+        pendingOutputs = outputs.size();
+        generation++;
+    }
+    frameReady.notify_all();
+
+    // La frame suivante n'est distribuée qu'une fois présentée partout
+    std::unique_lock<std::mutex> lock(mutex);
+    frameDone.wait(lock, [this]() { return pendingOutputs == 0 || stopping; });
+    if (stopping) {
+        return;
+    }
+
+    auto first = outputs.front()->presentedAt;
+    auto last = first;
+    for (const std::unique_ptr<Output>& output : outputs) {
+        first = std::min(first, output->presentedAt);
+        last = std::max(last, output->presentedAt);
+    }
+    double skewMs = std::chrono::duration<double, std::milli>(last - first).count();
+    windowSkewMs += skewMs;
+    maxSkewMs = std::max(maxSkewMs, skewMs);
+    windowFrames++;
+    report(last);
+}
+
+void VideoWall::report(Clock::time_point now) {
+    if (now - lastReport < REPORT_INTERVAL || windowFrames == 0) {
+        return;
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "Video wall: %zu outputs, present skew mean %.2f ms, max %.2f ms",
+             outputs.size(), windowSkewMs / windowFrames, maxSkewMs);
+    Logger::logPerformance(message);
+
+    windowFrames = 0;
+    windowSkewMs = 0.0;
+    maxSkewMs = 0.0;
+    lastReport = now;
+}
+
+void VideoWall::cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameReady.notify_all();
+    frameDone.notify_all();
+
+    for (std::unique_ptr<Output>& output : outputs) {
+        if (output->thread.joinable()) {
+            output->thread.join();
+        }
+        av_frame_free(&output->view);
+        av_frame_free(&output->pendingPrepare);
+    }
+    outputs.clear();
+    preparedSource = nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = false;
+    pendingOutputs = 0;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "Renderer.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Rectangle de la frame décodée (après réduction) affiché par une sortie, en pixels
+struct WallTile {
+    int display = 0;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+struct WallConfig {
+    // Grille uniforme : la tuile i (ligne par ligne) va sur l'écran i
+    int columns = 0;
+    int rows = 0;
+    // Rectangles explicites, prioritaires sur la grille
+    std::vector<WallTile> tiles;
+
+    bool enabled() const { return !tiles.empty() || columns * rows > 1; }
+};
+
+// Mur d'images : un seul décodage alimente plusieurs sorties, chacune avec son propre
+// backend de rendu et son thread. Chaque sortie reçoit une vue recadrée de la frame
+// partagée (nouvelle référence sur les mêmes buffers, sans copie). renderFrame() attend
+// que toutes les sorties aient présenté : toutes les tuiles montrent le même PTS.
+// prepareFrame() transmet les vues de la frame suivante à chaque sortie, dont le rendu
+// commence à les écrire pendant que la frame courante reste affichée.
+class VideoWall : public Renderer {
+public:
+    // options.displayIndex est remplacé par l'écran de chaque tuile
+    VideoWall(RendererBackend backend, const RendererOptions& options, const WallConfig& config);
+    ~VideoWall() override;
+
+    // width x height : taille des frames décodées, pour la grille et le bornage des rectangles
+    bool initialize(int width, int height) override;
+    void cleanup() override;
+    void prepareFrame(const AVFrame* frame) override;
+    void abandonPrepared() override;
+    void renderFrame(AVFrame* frame) override;
+    RendererBackend backend() const override { return outputBackend; }
+
+    // "CxR", par exemple "2x2"
+    static bool parseGrid(const std::string& value, int& columns, int& rows);
+    // "D:X,Y,WxH", par exemple "1:1920,0,1920x1080"
+    static bool parseTile(const std::string& value, WallTile& tile);
+    // Tuiles de taille paire couvrant toute la frame
+    static std::vector<WallTile> gridTiles(int columns, int rows, int width, int height);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Output {
+        WallTile tile;
+        std::unique_ptr<Renderer> renderer;
+        std::thread thread;
+        AVFrame* view;  // vue en attente de rendu, libérée par le thread de la sortie
+        // Vue de la frame suivante à préparer, reprise par le thread de la sortie
+        AVFrame* pendingPrepare;
+        bool renderPrepared;    // la génération courante est la vue préparée
+        bool abandonRequested;  // la vue préparée est jetée sans être rendue
+        Clock::time_point presentedAt;
+    };
+
+    void outputThreadFunction(Output& output, std::promise<bool> ready);
+    // Vue sur le rectangle de la tuile ; nullptr si la frame ne le contient pas
+    static AVFrame* cropView(const AVFrame* frame, const WallTile& tile);
+    void report(Clock::time_point now);
+
+    RendererBackend outputBackend;
+    RendererOptions outputOptions;
+    WallConfig config;
+    std::vector<std::unique_ptr<Output>> outputs;
+
+    std::mutex mutex;
+    std::condition_variable frameReady;  // nouvelle génération de vues pour les sorties
+    std::condition_variable frameDone;   // toutes les sorties ont présenté
+    uint64_t generation;
+    size_t pendingOutputs;
+    bool stopping;
+    // Frame de l'appelant dont les vues ont été transmises aux sorties pour préparation
+    const AVFrame* preparedSource;
+
+    // Écart entre la première et la dernière sortie à présenter une même frame
+    uint64_t windowFrames;
+    double windowSkewMs;
+    double maxSkewMs;
+    Clock::time_point lastReport;
+
+    static constexpr std::chrono::seconds REPORT_INTERVAL{1};
+};
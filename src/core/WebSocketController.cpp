@@ -6,7 +6,7 @@
 #include <random>
 
 WebSocketController::WebSocketController(VideoPlayer* p) 
-    : player(p), isRunning(false) {
+    : player(p), telemetryScheduled(false), isRunning(false) {
     // Utiliser une méthode plus simple pour générer le token
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -43,16 +43,14 @@ bool WebSocketController::initialize(const std::string& address, uint16_t port)
 }
 
 void WebSocketController::start() {
-    if (!isRunning) {
-        isRunning = true;
+    if (!isRunning.exchange(true)) {
         server.start_accept();
         server.run();
     }
 }
 
 void WebSocketController::stop() {
-    if (isRunning) {
-        isRunning = false;
+    if (isRunning.exchange(false)) {
         server.stop();
     }
 }
@@ -65,6 +63,7 @@ void WebSocketController::onOpen(ConnectionHdl hdl) {
 void WebSocketController::onClose(ConnectionHdl hdl) {
     Logger::logInfo("WebSocket connection closed");
     connections.erase(hdl.lock().get());
+    subscribers.erase(hdl);
 }
 
 void WebSocketController::onMessage(ConnectionHdl hdl, MessagePtr msg) {
@@ -95,6 +94,10 @@ void WebSocketController::onMessage(ConnectionHdl hdl, MessagePtr msg) {
             int volume = std::clamp(root["value"].asInt(), 0, 100);
             handleVolumeCommand(volume);
         }
+        else if (command == "seek") handleSeekCommand(root);
+        else if (command == "trace") handleTraceCommand(root);
+        else if (command == "subscribe") handleSubscribeCommand(hdl, root);
+        else if (command == "unsubscribe") handleUnsubscribeCommand(hdl);
     } catch (const std::exception& e) {
         Logger::logError("WebSocket message handling error: " + std::string(e.what()));
     }
@@ -120,6 +123,100 @@ void WebSocketController::handleVolumeCommand(int volume) {
     player->setVolume(volume);
 }
 
+void WebSocketController::handleSeekCommand(const Json::Value& root) {
+    if (root.isMember("frame")) {
+        player->seekToFrame(root["frame"].asInt64());
+    } else if (root.isMember("time")) {
+        player->seek(root["time"].asDouble());
+    } else {
+        Logger::logError("Seek command requires a time or frame value");
+    }
+}
+
+void WebSocketController::handleTraceCommand(const Json::Value& root) {
+    double seconds = root.isMember("seconds") ? std::max(0.1, root["seconds"].asDouble()) : 10.0;
+    player->dumpTrace(seconds);
+}
+
+void WebSocketController::handleSubscribeCommand(ConnectionHdl hdl, const Json::Value& root) {
+    double seconds = root.isMember("interval") ? root["interval"].asDouble() : 1.0;
+    seconds = std::clamp(seconds, MIN_TELEMETRY_INTERVAL, MAX_TELEMETRY_INTERVAL);
+
+    Subscriber subscriber;
+    subscriber.interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds));
+    subscriber.nextDue = std::chrono::steady_clock::now();
+    subscriber.skipped = 0;
+    subscribers[hdl] = subscriber;
+    scheduleTelemetry();
+}
+
+void WebSocketController::handleUnsubscribeCommand(ConnectionHdl hdl) {
+    subscribers.erase(hdl);
+}
+
+void WebSocketController::scheduleTelemetry() {
+    // Le minuteur ne tourne que tant qu'il y a des abonnés
+    if (telemetryScheduled || subscribers.empty()) {
+        return;
+    }
+    telemetryScheduled = true;
+    server.set_timer(TELEMETRY_TICK.count(),
+        std::bind(&WebSocketController::onTelemetryTick, this, std::placeholders::_1));
+}
+
+void WebSocketController::onTelemetryTick(const websocketpp::lib::error_code& ec) {
+    telemetryScheduled = false;
+    if (ec || !isRunning) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::string snapshot;
+    for (auto it = subscribers.begin(); it != subscribers.end();) {
+        Subscriber& subscriber = it->second;
+        websocketpp::lib::error_code connectionError;
+        Server::connection_ptr connection = server.get_con_from_hdl(it->first, connectionError);
+        if (connectionError) {
+            it = subscribers.erase(it);
+            continue;
+        }
+        if (now < subscriber.nextDue) {
+            ++it;
+            continue;
+        }
+        subscriber.nextDue += subscriber.interval;
+        if (subscriber.nextDue < now) {
+            subscriber.nextDue = now + subscriber.interval;
+        }
+
+        // Client lent : on saute cet instantané, le suivant sera plus récent de toute façon
+        if (connection->get_buffered_amount() > MAX_BUFFERED_BYTES) {
+            subscriber.skipped++;
+            if (subscriber.interval * subscriber.skipped > SLOW_CLIENT_TIMEOUT) {
+                Logger::logError("Closing WebSocket client too slow for telemetry");
+                server.close(it->first, websocketpp::close::status::going_away, "Telemetry backlog", connectionError);
+                it = subscribers.erase(it);
+                continue;
+            }
+            ++it;
+            continue;
+        }
+        subscriber.skipped = 0;
+
+        if (snapshot.empty()) {
+            snapshot = telemetry.sample();
+        }
+        server.send(it->first, snapshot, websocketpp::frame::opcode::text, connectionError);
+        if (connectionError) {
+            it = subscribers.erase(it);
+            continue;
+        }
+        ++it;
+    }
+    scheduleTelemetry();
+}
+
 bool WebSocketController::validateAuth(const std::string& token) {
     return token == authToken;
 } 
\ No newline at end of file
@@ -2,7 +2,11 @@
 #include <websocketpp/server.hpp>
 #include <websocketpp/config/asio.hpp>
 #include <json/json.h>
+#include "TelemetrySampler.h"
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <string>
 #include <map>
 
@@ -32,10 +36,38 @@ private:
     void handleStopCommand();
     void handleResetCommand();
     void handleVolumeCommand(int volume);
+    void handleSeekCommand(const Json::Value& root);
+    void handleTraceCommand(const Json::Value& root);
+    void handleSubscribeCommand(ConnectionHdl hdl, const Json::Value& root);
+    void handleUnsubscribeCommand(ConnectionHdl hdl);
+
+    // Télémétrie : tout se passe sur le thread du serveur, sans verrou.
+    // Chaque instantané est sérialisé une fois puis envoyé à tous les abonnés dus ;
+    // un client dont le tampon d'envoi déborde saute ses instantanés au lieu de les accumuler.
+    struct Subscriber {
+        std::chrono::steady_clock::duration interval;
+        std::chrono::steady_clock::time_point nextDue;
+        // Instantanés sautés d'affilée parce que le client ne lit pas assez vite
+        int skipped;
+    };
+
+    void scheduleTelemetry();
+    void onTelemetryTick(const websocketpp::lib::error_code& ec);
 
     Server server;
     VideoPlayer* player;
     std::string authToken;
     std::map<void*, bool> connections;
-    bool isRunning;
+    std::map<ConnectionHdl, Subscriber, std::owner_less<ConnectionHdl>> subscribers;
+    TelemetrySampler telemetry;
+    bool telemetryScheduled;
+    std::atomic<bool> isRunning;  // lu par le thread du serveur, écrit par stop() depuis un autre thread
+
+    static constexpr std::chrono::milliseconds TELEMETRY_TICK{100};
+    static constexpr double MIN_TELEMETRY_INTERVAL = 0.1;
+    static constexpr double MAX_TELEMETRY_INTERVAL = 60.0;
+    // Au-delà, le client n'a pas lu les instantanés précédents : le suivant est sauté
+    static constexpr size_t MAX_BUFFERED_BYTES = 64 * 1024;
+    // Un client bloqué plus longtemps est déconnecté
+    static constexpr std::chrono::seconds SLOW_CLIENT_TIMEOUT{30};
 }; 
\ No newline at end of file
@@ -1,17 +1,183 @@
 #include "VideoPlayer.h"
 //#include "WebSocketController.h"  // Commenté temporairement
 #include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
+struct PlayerOptions {
+    std::string videoPath;
+    DecoderConfig decoderConfig;
+    QueueLimits audioQueue = AudioManager::DEFAULT_QUEUE_LIMITS;
+    int audioDeviceSamples = AudioManager::DEFAULT_DEVICE_BUFFER_SAMPLES;
+    RendererBackend renderer = RendererBackend::Sdl;
+    RendererOptions rendererOptions;
+    uint64_t frameLimit = 0;
+    WallConfig wall;
+    LogLevel logLevel = LogLevel::Info;
+    double metricsInterval = 5.0;
+    std::string tracePath;
+    double traceSeconds = 10.0;
+};
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <video_file>" << std::endl
+              << "Options:" << std::endl
+              << "  --decode-threads=auto|frame|slice|off  Software decoder threading (default: auto)" << std::endl
+              << "  --decode-thread-count=N                Decoder threads, 0 = one per core (default: 0)" << std::endl
+              << "  --video-buffer-mb=N                    Decoded video queue memory budget (default: 256)" << std::endl
+              << "  --video-buffer-seconds=S               Decoded video queue duration budget (default: 2)" << std::endl
+              << "  --audio-buffer-mb=N                    Decoded audio queue memory budget (default: 16)" << std::endl
+              << "  --audio-buffer-seconds=S               Decoded audio queue duration budget (default: 2)" << std::endl
+              << "  --audio-device-samples=N               Audio device buffer, lower = less latency (default: 1024)" << std::endl
+              << "  --probe-size-kb=N                      Data probed when opening the file, 0 = FFmpeg default (default: 0)" << std::endl
+              << "  --analyze-duration-ms=N                Duration analyzed when opening the file, 0 = FFmpeg default (default: 0)" << std::endl
+              << "  --loop=seek|gapless|cache              Loop by seeking, from a pre-decoded start, or from RAM (default: seek)" << std::endl
+              << "  --loop-preroll-seconds=S               Duration pre-decoded for gapless looping (default: 2)" << std::endl
+              << "  --loop-cache-mb=N                      Memory budget of the loop cache (default: 512)" << std::endl
+              << "  --downscale=off|display|WxH            Downscale frames before upload, keeping the aspect ratio (default: off)" << std::endl
+              << "  --renderer=sdl|null                    null: no display or audio, frames rendered to memory unpaced (default: sdl)" << std::endl
+              << "  --texture-upload=ring|update           Texture writes from a converter thread, or at present time (default: ring)" << std::endl
+              << "  --frames=N                             Stop after N rendered frames, 0 = play forever (default: 0)" << std::endl
+              << "  --wall=CxR                             Split each frame into a CxR grid, tile i shown on display i" << std::endl
+              << "  --wall-tile=D:X,Y,WxH                  Show the WxH rectangle at X,Y on display D; repeat for each tile" << std::endl
+              << "  --log-level=debug|info|perf|error|off  Minimum level of logged messages (default: info)" << std::endl
+              << "  --metrics-interval=S                   Seconds between performance summaries, 0 = off (default: 5)" << std::endl
+              << "  --trace=FILE                           Record pipeline spans; SIGUSR1 writes them to FILE as Chrome trace JSON" << std::endl
+              << "  --trace-seconds=S                      Duration written on SIGUSR1 (default: 10)" << std::endl;
+}
+
+static size_t parseMegabytes(const std::string& value) {
+    return static_cast<size_t>(std::max(1L, std::atol(value.c_str()))) * 1024 * 1024;
+}
+
+static double parseSeconds(const std::string& value) {
+    return std::max(0.1, std::atof(value.c_str()));
+}
+
+static bool parseDownscale(const std::string& value, DecoderConfig& config) {
+    config.downscaleToDisplay = value == "display";
+    config.downscaleWidth = 0;
+    config.downscaleHeight = 0;
+    if (value == "off" || value == "display") {
+        return true;
+    }
+
+    size_t separator = value.find('x');
+    if (separator == std::string::npos) {
+        return false;
+    }
+    config.downscaleWidth = std::atoi(value.substr(0, separator).c_str());
+    config.downscaleHeight = std::atoi(value.substr(separator + 1).c_str());
+    return config.downscaleWidth > 0 && config.downscaleHeight > 0;
+}
+
+static bool parseArguments(int argc, char* argv[], PlayerOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+
+        if (arg.rfind("--decode-threads=", 0) == 0) {
+            if (!VideoDecoder::parseThreading(value, options.decoderConfig.threading)) {
+                std::cerr << "Invalid decoder threading mode: " << value << std::endl;
+                return false;
+            }
+        } else if (arg.rfind("--decode-thread-count=", 0) == 0) {
+            options.decoderConfig.threadCount = std::max(0, std::atoi(value.c_str()));
+        } else if (arg.rfind("--video-buffer-mb=", 0) == 0) {
+            options.decoderConfig.videoQueue.maxBytes = parseMegabytes(value);
+        } else if (arg.rfind("--video-buffer-seconds=", 0) == 0) {
+            options.decoderConfig.videoQueue.maxSeconds = parseSeconds(value);
+        } else if (arg.rfind("--audio-buffer-mb=", 0) == 0) {
+            options.audioQueue.maxBytes = parseMegabytes(value);
+        } else if (arg.rfind("--audio-buffer-seconds=", 0) == 0) {
+            options.audioQueue.maxSeconds = parseSeconds(value);
+        } else if (arg.rfind("--audio-device-samples=", 0) == 0) {
+            options.audioDeviceSamples = std::max(64, std::atoi(value.c_str()));
+        } else if (arg.rfind("--probe-size-kb=", 0) == 0) {
+            options.decoderConfig.probeSize = std::max(0L, std::atol(value.c_str())) * 1024;
+        } else if (arg.rfind("--analyze-duration-ms=", 0) == 0) {
+            options.decoderConfig.analyzeDurationUs = std::max(0L, std::atol(value.c_str())) * 1000;
+        } else if (arg.rfind("--loop=", 0) == 0) {
+            if (!VideoDecoder::parseLoopMode(value, options.decoderConfig.loopMode)) {
+                std::cerr << "Invalid loop mode: " << value << std::endl;
+                return false;
+            }
+        } else if (arg.rfind("--loop-preroll-seconds=", 0) == 0) {
+            options.decoderConfig.loopPrerollSeconds = parseSeconds(value);
+        } else if (arg.rfind("--loop-cache-mb=", 0) == 0) {
+            options.decoderConfig.loopCacheBytes = parseMegabytes(value);
+        } else if (arg.rfind("--downscale=", 0) == 0) {
+            if (!parseDownscale(value, options.decoderConfig)) {
+                std::cerr << "Invalid downscale size: " << value << std::endl;
+                return false;
+            }
+        } else if (arg.rfind("--renderer=", 0) == 0) {
+            if (!Renderer::parseBackend(value, options.renderer)) {
+                std::cerr << "Invalid renderer: " << value << std::endl;
+                return false;
+            }
+        } else if (arg.rfind("--texture-upload=", 0) == 0) {
+            if (!Renderer::parseTextureUpload(value, options.rendererOptions.textureUpload)) {
+                std::cerr << "Invalid texture upload mode: " << value << std::endl;
+                return false;
+            }
+        } else if (arg.rfind("--frames=", 0) == 0) {
+            options.frameLimit = static_cast<uint64_t>(std::max(0L, std::atol(value.c_str())));
+        } else if (arg.rfind("--wall=", 0) == 0) {
+            if (!VideoWall::parseGrid(value, options.wall.columns, options.wall.rows)) {
+                std::cerr << "Invalid wall grid: " << value << std::endl;
+                return false;
+            }
+        } else if (arg.rfind("--wall-tile=", 0) == 0) {
+            WallTile tile;
+            if (!VideoWall::parseTile(value, tile)) {
+                std::cerr << "Invalid wall tile: " << value << std::endl;
+                return false;
+            }
+            options.wall.tiles.push_back(tile);
+        } else if (arg.rfind("--metrics-interval=", 0) == 0) {
+            options.metricsInterval = std::max(0.0, std::atof(value.c_str()));
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            options.tracePath = value;
+        } else if (arg.rfind("--trace-seconds=", 0) == 0) {
+            options.traceSeconds = parseSeconds(value);
+        } else if (arg.rfind("--log-level=", 0) == 0) {
+            if (!Logger::parseLevel(value, options.logLevel)) {
+                std::cerr << "Invalid log level: " << value << std::endl;
+                return false;
+            }
+        } else if (arg.rfind("--", 0) == 0 || !options.videoPath.empty()) {
+            std::cerr << "Unexpected argument: " << arg << std::endl;
+            return false;
+        } else {
+            options.videoPath = arg;
+        }
+    }
+    return !options.videoPath.empty();
+}
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <video_file>" << std::endl;
+    PlayerOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
         return 1;
     }
 
+    Logger::setLevel(options.logLevel);
     VideoPlayer player;
     //WebSocketController wsController(&player);  // Commenté temporairement
+    player.setDecoderConfig(options.decoderConfig);
+    player.setAudioQueueLimits(options.audioQueue);
+    player.setAudioDeviceSamples(options.audioDeviceSamples);
+    player.setRendererBackend(options.renderer);
+    player.setRendererOptions(options.rendererOptions);
+    player.setFrameLimit(options.frameLimit);
+    player.setWallConfig(options.wall);
+    player.setMetricsInterval(options.metricsInterval);
+    player.setTraceOutput(options.tracePath, options.traceSeconds);
 
-    if (!player.initialize(argv[1])) {
+    if (!player.initialize(options.videoPath)) {
+        Logger::flush();
         return 1;
     }
 
@@ -22,5 +188,6 @@ int main(int argc, char* argv[]) {
 
     player.run();
 
+    Logger::flush();
     return 0;
-} 
\ No newline at end of file
+}
@@ -1,25 +1,209 @@
 #include "Logger.h"
-#include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <initializer_list>
+#include <memory>
+#include <thread>
 
-void Logger::logInfo(const std::string& message) {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::cout << "[INFO " << std::put_time(std::localtime(&time), "%H:%M:%S") << "] " 
-              << message << std::endl;
+std::atomic<int> Logger::minimumLevel(static_cast<int>(LogLevel::Info));
+
+namespace {
+
+struct LogRecord {
+    LogLevel level;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
+// File bornée multi-producteurs sans verrou (numéros de séquence par case) ; un seul consommateur
+class LogQueue {
+public:
+    explicit LogQueue(size_t capacity)
+        : cells(new Cell[capacity])
+        , mask(capacity - 1)
+        , enqueuePosition(0)
+        , dequeuePosition(0) {
+        for (size_t i = 0; i < capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(LogRecord&& record) {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            ptrdiff_t difference = static_cast<ptrdiff_t>(sequence - position);
+            if (difference == 0) {
+                // Case libre : la réserver, sinon un autre producteur l'a prise avant
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.record = std::move(record);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;  // pleine
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(LogRecord& record) {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        Cell& cell = cells[position & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<ptrdiff_t>(sequence - (position + 1)) < 0) {
+            return false;  // vide, ou écriture pas encore publiée
+        }
+        record = std::move(cell.record);
+        dequeuePosition.store(position + 1, std::memory_order_relaxed);
+        cell.sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePosition;
+    alignas(64) std::atomic<size_t> dequeuePosition;
+};
+
+// Thread d'écriture : formate l'heure et écrit par lots, un seul flush par lot
+class LogWriter {
+public:
+    LogWriter()
+        : queue(CAPACITY)
+        , pushed(0)
+        , written(0)
+        , dropped(0)
+        , running(true)
+        , thread(&LogWriter::run, this) {
+    }
+
+    ~LogWriter() {
+        running = false;
+        thread.join();
+    }
+
+    void push(LogLevel level, const std::string& message) {
+        LogRecord record{level, std::chrono::system_clock::now(), message};
+        if (queue.tryPush(std::move(record))) {
+            pushed.fetch_add(1, std::memory_order_release);
+        } else if (level == LogLevel::Error) {
+            // Une erreur n'est jamais perdue : écrite directement, hors ordre
+            write(record);
+        } else {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void flush() {
+        uint64_t target = pushed.load(std::memory_order_acquire);
+        while (written.load(std::memory_order_acquire) < target && running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+private:
+    void run() {
+        while (running) {
+            if (!drain()) {
+                std::this_thread::sleep_for(POLL_INTERVAL);
+            }
+        }
+        drain();
+    }
+
+    // Vrai si au moins un message a été écrit
+    bool drain() {
+        LogRecord record;
+        uint64_t count = 0;
+        while (queue.tryPop(record)) {
+            write(record);
+            count++;
+        }
+        uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost > 0) {
+            write(LogRecord{LogLevel::Error, std::chrono::system_clock::now(),
+                            std::to_string(lost) + " log messages dropped, log queue full"});
+        }
+        if (count == 0 && lost == 0) {
+            return false;
+        }
+        std::cout.flush();
+        std::cerr.flush();
+        written.fetch_add(count, std::memory_order_release);
+        return true;
+    }
+
+    static void write(const LogRecord& record) {
+        std::time_t time = std::chrono::system_clock::to_time_t(record.time);
+        std::tm local;
+        localtime_r(&time, &local);
+        std::ostream& out = record.level == LogLevel::Error ? std::cerr : std::cout;
+        out << "[" << levelTag(record.level) << " " << std::put_time(&local, "%H:%M:%S") << "] "
+            << record.message << '\n';
+    }
+
+    static const char* levelTag(LogLevel level) {
+        switch (level) {
+            case LogLevel::Debug: return "DEBUG";
+            case LogLevel::Performance: return "PERF";
+            case LogLevel::Error: return "ERROR";
+            default: return "INFO";
+        }
+    }
+
+    static constexpr size_t CAPACITY = 8192;  // puissance de deux
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{10};
+
+    LogQueue queue;
+    std::atomic<uint64_t> pushed;
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> dropped;
+    std::atomic<bool> running;
+    std::thread thread;
+};
+
+LogWriter& writer() {
+    static LogWriter instance;
+    return instance;
 }
 
-void Logger::logError(const std::string& message) {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::cerr << "[ERROR " << std::put_time(std::localtime(&time), "%H:%M:%S") << "] " 
-              << message << std::endl;
+}  // namespace
+
+void Logger::log(LogLevel level, const std::string& message) {
+    if (isEnabled(level)) {
+        writer().push(level, message);
+    }
+}
+
+void Logger::flush() {
+    writer().flush();
 }
 
-void Logger::logPerformance(const std::string& message) {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::cout << "[PERF " << std::put_time(std::localtime(&time), "%H:%M:%S") << "] " 
-              << message << std::endl;
-} 
\ No newline at end of file
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Performance: return "perf";
+        case LogLevel::Error: return "error";
+        default: return "off";
+    }
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    for (LogLevel candidate : {LogLevel::Debug, LogLevel::Info, LogLevel::Performance, LogLevel::Error, LogLevel::Off}) {
+        if (name == levelName(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,10 +1,104 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <string>
 
+enum class LogLevel {
+    Debug,
+    Info,
+    Performance,
+    Error,
+    Off
+};
+
+// Niveau minimal compilé : les appels LOG_* en dessous disparaissent à la compilation
+#ifndef LOGGER_COMPILED_LEVEL
+#define LOGGER_COMPILED_LEVEL 0
+#endif
+
+// Journal asynchrone : les producteurs déposent l'enregistrement dans une file bornée sans
+// verrou et un thread d'écriture la vide vers stdout/stderr. Une file pleine fait perdre le
+// message (compté) plutôt que de bloquer un thread de décodage ou de rendu.
 class Logger {
 public:
-    static void logInfo(const std::string& message);
-    static void logError(const std::string& message);
-    static void logPerformance(const std::string& message);
-}; 
\ No newline at end of file
+    static void logDebug(const std::string& message) { log(LogLevel::Debug, message); }
+    static void logInfo(const std::string& message) { log(LogLevel::Info, message); }
+    static void logError(const std::string& message) { log(LogLevel::Error, message); }
+    static void logPerformance(const std::string& message) { log(LogLevel::Performance, message); }
+    static void log(LogLevel level, const std::string& message);
+
+    static void setLevel(LogLevel level) { minimumLevel.store(static_cast<int>(level), std::memory_order_relaxed); }
+    static LogLevel getLevel() { return static_cast<LogLevel>(minimumLevel.load(std::memory_order_relaxed)); }
+    static constexpr bool isCompiled(LogLevel level) { return static_cast<int>(level) >= LOGGER_COMPILED_LEVEL; }
+    static bool isEnabled(LogLevel level) {
+        return isCompiled(level) && static_cast<int>(level) >= minimumLevel.load(std::memory_order_relaxed);
+    }
+    // Attend que tout ce qui a été déposé soit écrit
+    static void flush();
+
+    static const char* levelName(LogLevel level);
+    static bool parseLevel(const std::string& name, LogLevel& level);
+
+private:
+    static std::atomic<int> minimumLevel;
+};
+
+// Limite un point d'appel à un message par intervalle ; les messages écartés sont comptés
+// et signalés avec le suivant. Un par point d'appel (statique local des macros LOG_*_EVERY).
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(std::chrono::milliseconds interval)
+        : interval(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count())
+        , nextAllowed(0)
+        , suppressed(0) {
+    }
+
+    // Vrai si le message peut passer ; skipped reçoit le nombre de messages écartés depuis le précédent
+    bool allow(uint64_t& skipped) {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t next = nextAllowed.load(std::memory_order_relaxed);
+        if (now < next || !nextAllowed.compare_exchange_strong(next, now + interval, std::memory_order_relaxed)) {
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        skipped = suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    const int64_t interval;
+    std::atomic<int64_t> nextAllowed;
+    std::atomic<uint64_t> suppressed;
+};
+
+// Le message n'est construit que si le niveau est actif
+#define LOG_AT(level, message)                                  \
+    do {                                                        \
+        if (Logger::isCompiled(level) && Logger::isEnabled(level)) { \
+            Logger::log(level, message);                        \
+        }                                                       \
+    } while (0)
+
+#define LOG_AT_EVERY(level, intervalMs, message)                                                  \
+    do {                                                                                          \
+        if (Logger::isCompiled(level) && Logger::isEnabled(level)) {                              \
+            static LogRateLimiter logRateLimiter{std::chrono::milliseconds(intervalMs)};          \
+            uint64_t logSkipped = 0;                                                              \
+            if (logRateLimiter.allow(logSkipped)) {                                               \
+                Logger::log(level, logSkipped > 0 ? std::string(message) + " (" +                 \
+                                                        std::to_string(logSkipped) + " suppressed)" \
+                                                  : std::string(message));                        \
+            }                                                                                     \
+        }                                                                                         \
+    } while (0)
+
+#define LOG_DEBUG(message) LOG_AT(LogLevel::Debug, message)
+#define LOG_INFO(message) LOG_AT(LogLevel::Info, message)
+#define LOG_PERF(message) LOG_AT(LogLevel::Performance, message)
+#define LOG_ERROR(message) LOG_AT(LogLevel::Error, message)
+// Messages par paquet ou par frame : au plus un par intervalle
+#define LOG_DEBUG_EVERY(intervalMs, message) LOG_AT_EVERY(LogLevel::Debug, intervalMs, message)
+#define LOG_INFO_EVERY(intervalMs, message) LOG_AT_EVERY(LogLevel::Info, intervalMs, message)
@@ -0,0 +1,131 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <time.h>
+
+Histogram::Histogram() : sum(0) {
+    for (std::atomic<uint64_t>& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.count = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        snapshot.counts[i] = counts[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[i];
+    }
+    snapshot.sum = sum.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+Histogram::Snapshot Histogram::Snapshot::since(const Snapshot& previous) const {
+    Snapshot difference;
+    for (int i = 0; i < BUCKETS; i++) {
+        difference.counts[i] = counts[i] - previous.counts[i];
+    }
+    difference.sum = sum - previous.sum;
+    difference.count = count - previous.count;
+    return difference;
+}
+
+double Histogram::bucketLower(int bucket) {
+    if (bucket < 4) {
+        return bucket;
+    }
+    int octave = bucket / 4 + 1;
+    return static_cast<double>(static_cast<uint64_t>(4 + bucket % 4) << (octave - 2));
+}
+
+double Histogram::Snapshot::percentile(double fraction) const {
+    if (count == 0) {
+        return 0.0;
+    }
+    double rank = fraction * count;
+    uint64_t cumulative = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        if (counts[i] > 0 && cumulative + counts[i] >= rank) {
+            double lower = bucketLower(i);
+            return lower + (bucketUpper(i) - lower) * (rank - cumulative) / counts[i];
+        }
+        cumulative += counts[i];
+    }
+    return bucketLower(BUCKETS - 1);
+}
+
+namespace {
+
+// Jamais détruit : des threads détachés peuvent encore enregistrer pendant la sortie du programme
+template <typename Metric>
+Metric& lookup(const std::string& name) {
+    static std::mutex mutex;
+    static auto* metrics = new std::map<std::string, std::unique_ptr<Metric>>();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<Metric>& metric = (*metrics)[name];
+    if (!metric) {
+        metric.reset(new Metric());
+    }
+    return *metric;
+}
+
+struct RegisteredThread {
+    uint64_t id;
+    std::string name;
+    clockid_t clock;
+};
+
+std::mutex threadsMutex;
+std::vector<RegisteredThread>* registeredThreads = new std::vector<RegisteredThread>();
+uint64_t nextThreadId = 1;
+
+}  // namespace
+
+Counter& Metrics::counter(const std::string& name) {
+    return lookup<Counter>(name);
+}
+
+Gauge& Metrics::gauge(const std::string& name) {
+    return lookup<Gauge>(name);
+}
+
+Histogram& Metrics::histogram(const std::string& name) {
+    return lookup<Histogram>(name);
+}
+
+uint64_t Metrics::registerThread(const std::string& name) {
+    clockid_t clock;
+    if (pthread_getcpuclockid(pthread_self(), &clock) != 0) {
+        return 0;
+    }
+    return registerThreadClock(name, clock);
+}
+
+uint64_t Metrics::registerThreadClock(const std::string& name, clockid_t clock) {
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    uint64_t id = nextThreadId++;
+    registeredThreads->push_back({id, name, clock});
+    return id;
+}
+
+void Metrics::unregisterThread(uint64_t id) {
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    registeredThreads->erase(std::remove_if(registeredThreads->begin(), registeredThreads->end(),
+                                            [id](const RegisteredThread& thread) { return thread.id == id; }),
+                             registeredThreads->end());
+}
+
+std::vector<Metrics::ThreadCpuTime> Metrics::threadCpuTimes() {
+    std::vector<ThreadCpuTime> times;
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    for (const RegisteredThread& thread : *registeredThreads) {
+        timespec time;
+        if (clock_gettime(thread.clock, &time) == 0) {
+            times.push_back({thread.name, time.tv_sec + time.tv_nsec / 1e9});
+        }
+    }
+    return times;
+}
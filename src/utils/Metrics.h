@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Compteur cumulatif ; incrément atomique relâché, utilisable depuis le callback audio
+class Counter {
+public:
+    Counter() : value(0) {}
+    void add(uint64_t count = 1) { value.fetch_add(count, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<uint64_t> value;
+};
+
+// Dernière valeur observée
+class Gauge {
+public:
+    Gauge() : value(0.0) {}
+    void set(double newValue) { value.store(newValue, std::memory_order_relaxed); }
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<double> value;
+};
+
+// Histogramme à seaux fixes : quatre par puissance de deux (écart relatif de 25 % au plus),
+// de 0 à 2^25 ; au-delà, tout tombe dans le dernier seau.
+// Enregistrer coûte deux incréments atomiques ; les percentiles sont interpolés dans le seau.
+class Histogram {
+public:
+    static constexpr int BUCKETS = 96;
+
+    struct Snapshot {
+        uint64_t counts[BUCKETS];
+        uint64_t sum;
+        uint64_t count;
+
+        double mean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+        double percentile(double fraction) const;
+        // Enregistrements faits depuis previous
+        Snapshot since(const Snapshot& previous) const;
+    };
+
+    Histogram();
+    void record(uint64_t value) {
+        counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+    }
+    // En microsecondes
+    void recordDuration(std::chrono::steady_clock::duration duration) {
+        int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        record(us > 0 ? static_cast<uint64_t>(us) : 0);
+    }
+    Snapshot snapshot() const;
+
+private:
+    // Sous 4 : un seau par valeur ; au-delà, octave et deux bits suivant le bit de tête
+    static int bucketOf(uint64_t value) {
+        if (value < 4) {
+            return static_cast<int>(value);
+        }
+        int octave = 63 - __builtin_clzll(value);
+        int bucket = (octave - 1) * 4 + static_cast<int>((value >> (octave - 2)) & 3);
+        return bucket < BUCKETS ? bucket : BUCKETS - 1;
+    }
+    // Bornes [lower, upper) du seau
+    static double bucketLower(int bucket);
+    static double bucketUpper(int bucket) { return bucket + 1 < BUCKETS ? bucketLower(bucket + 1) : bucketLower(bucket) * 1.25; }
+
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> sum;
+};
+
+// Registre des métriques par nom. La recherche prend un verrou : les producteurs gardent la
+// référence obtenue une fois (elle reste valide jusqu'à la fin du programme), puis
+// n'effectuent que des opérations atomiques sur le chemin critique.
+class Metrics {
+public:
+    struct ThreadCpuTime {
+        std::string name;
+        double seconds;
+    };
+
+    static Counter& counter(const std::string& name);
+    static Gauge& gauge(const std::string& name);
+    static Histogram& histogram(const std::string& name);
+
+    // Suivi du temps CPU du thread courant, jusqu'à unregisterThread() avec l'identifiant
+    // renvoyé (0 : échec) ; voir ThreadCpuScope
+    static uint64_t registerThread(const std::string& name);
+    // Pour un thread temps réel qui ne peut pas verrouiller : son horloge CPU
+    // (pthread_getcpuclockid) est enregistrée depuis un autre thread
+    static uint64_t registerThreadClock(const std::string& name, clockid_t clock);
+    // À appeler avant la fin du thread : son identifiant système peut être réutilisé
+    static void unregisterThread(uint64_t id);
+    // Temps CPU cumulé de chaque thread enregistré
+    static std::vector<ThreadCpuTime> threadCpuTimes();
+
+    // Noms des métriques du lecteur
+    static constexpr const char* PRESENTED_FRAMES = "frames.presented";
+    static constexpr const char* DROPPED_FRAMES = "frames.dropped";
+    static constexpr const char* DECODE_TIME_US = "video.decode_us";
+    static constexpr const char* RENDER_TIME_US = "video.render_us";
+    static constexpr const char* VIDEO_QUEUE_DEPTH = "video.queue_frames";
+    static constexpr const char* VIDEO_PACKET_QUEUE_DEPTH = "demux.video_packets";
+    static constexpr const char* AUDIO_PACKET_QUEUE_DEPTH = "demux.audio_packets";
+    static constexpr const char* AUDIO_BUFFER_MS = "audio.buffer_ms";
+    static constexpr const char* AUDIO_UNDERRUNS = "audio.underruns";
+    static constexpr const char* AUDIO_LATENCY_MS = "audio.latency_ms";
+    static constexpr const char* AV_DRIFT_MS = "sync.drift_ms";
+    static constexpr const char* AV_DRIFT_US = "sync.abs_drift_us";
+};
+
+// Temps CPU du thread suivi pendant la portée ; à déclarer au début de la fonction du thread
+class ThreadCpuScope {
+public:
+    explicit ThreadCpuScope(const std::string& name) : id(Metrics::registerThread(name)) {}
+    ~ThreadCpuScope() { Metrics::unregisterThread(id); }
+
+    ThreadCpuScope(const ThreadCpuScope&) = delete;
+    ThreadCpuScope& operator=(const ThreadCpuScope&) = delete;
+
+private:
+    uint64_t id;
+};
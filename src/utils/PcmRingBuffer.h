@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Tampon circulaire d'octets PCM single-producer/single-consumer, sans verrou ni allocation
+// après construction : le consommateur peut être le callback temps réel de SDL.
+// Les positions sont des compteurs d'octets croissants ; seule leur différence compte.
+class PcmRingBuffer {
+public:
+    explicit PcmRingBuffer(size_t capacity = 0)
+        : buffer(roundUpToPowerOfTwo(capacity))
+        , mask(buffer.size() - 1)
+        , readPosition(0)
+        , writePosition(0)
+        , flushPosition(0) {
+    }
+
+    PcmRingBuffer(const PcmRingBuffer&) = delete;
+    PcmRingBuffer& operator=(const PcmRingBuffer&) = delete;
+
+    // Producteur uniquement : copie ce qui tient, renvoie le nombre d'octets écrits.
+    // Après flush(), la place n'est rendue qu'une fois la lecture passée au-delà des octets abandonnés
+    size_t write(const uint8_t* data, size_t bytes) {
+        const size_t tail = writePosition.load(std::memory_order_relaxed);
+        const size_t head = readPosition.load(std::memory_order_acquire);
+        bytes = std::min(bytes, buffer.size() - (tail - head));
+
+        const size_t offset = tail & mask;
+        const size_t first = std::min(bytes, buffer.size() - offset);
+        memcpy(buffer.data() + offset, data, first);
+        memcpy(buffer.data(), data + first, bytes - first);
+        writePosition.store(tail + bytes, std::memory_order_release);
+        return bytes;
+    }
+
+    // Producteur uniquement : le consommateur sautera tout ce qui est déjà écrit à sa prochaine lecture
+    void flush() {
+        flushPosition.store(writePosition.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    // Consommateur uniquement : copie jusqu'à bytes octets, renvoie le nombre d'octets lus
+    size_t read(uint8_t* data, size_t bytes) {
+        return read(data, bytes, [](uint8_t* dst, const uint8_t* src, size_t count) { memcpy(dst, src, count); });
+    }
+
+    // Comme read(), chaque segment contigu étant copié par copy(dst, src, count) : permet de
+    // transformer les échantillons au passage. Les segments restent alignés sur les trames
+    // tant que les écritures et les lectures sont des multiples de la taille de trame.
+    template <typename Copy>
+    size_t read(uint8_t* data, size_t bytes, Copy copy) {
+        const size_t head = pendingReadPosition();
+        const size_t tail = writePosition.load(std::memory_order_acquire);
+        bytes = std::min(bytes, tail - head);
+
+        const size_t offset = head & mask;
+        const size_t first = std::min(bytes, buffer.size() - offset);
+        if (first > 0) {
+            copy(data, buffer.data() + offset, first);
+        }
+        if (bytes > first) {
+            copy(data + first, buffer.data(), bytes - first);
+        }
+        readPosition.store(head + bytes, std::memory_order_release);
+        return bytes;
+    }
+
+    // Octets restant à lire, sans ceux abandonnés par flush() ; approximatif depuis un troisième thread
+    size_t available() const {
+        return writePosition.load(std::memory_order_acquire) - pendingReadPosition();
+    }
+    // Octets occupés, y compris ceux abandonnés que le consommateur n'a pas encore sautés :
+    // c'est cette place qui limite write()
+    size_t filled() const {
+        return writePosition.load(std::memory_order_relaxed) - readPosition.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return buffer.size(); }
+    // Positions absolues, pour associer des PTS aux octets écrits
+    size_t getReadPosition() const { return readPosition.load(std::memory_order_acquire); }
+    size_t getWritePosition() const { return writePosition.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Position de la prochaine lecture, au-delà d'un flush() pas encore vu par le consommateur
+    size_t pendingReadPosition() const {
+        const size_t head = readPosition.load(std::memory_order_acquire);
+        const size_t flushed = flushPosition.load(std::memory_order_acquire);
+        return static_cast<ptrdiff_t>(flushed - head) > 0 ? flushed : head;
+    }
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    std::vector<uint8_t> buffer;
+    const size_t mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> readPosition;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> writePosition;
+    std::atomic<size_t> flushPosition;
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Limites d'une file exprimées en mémoire et en durée de présentation
+struct QueueLimits {
+    size_t maxBytes;
+    double maxSeconds;
+    double lowWatermark = 0.75;  // fraction des limites sous laquelle le producteur reprend
+};
+
+// Budget partagé entre un producteur et un consommateur.
+// Le producteur s'arrête dès qu'une limite est atteinte (seuil haut) et ne reprend
+// qu'une fois les deux repassées sous le seuil bas, ce qui évite d'osciller frame par frame.
+class QueueBudget {
+public:
+    explicit QueueBudget(const QueueLimits& queueLimits)
+        : limits(queueLimits)
+        , queuedBytes(0)
+        , queuedMicros(0)
+        , throttled(false)
+        , producerWaiting(false)
+        , interrupted(false) {
+    }
+
+    // À appeler avant que le producteur ne démarre
+    void setLimits(const QueueLimits& queueLimits) { limits = queueLimits; }
+    const QueueLimits& getLimits() const { return limits; }
+
+    void add(size_t bytes, double seconds) {
+        queuedBytes += bytes;
+        queuedMicros += toMicros(seconds);
+    }
+
+    void release(size_t bytes, double seconds) {
+        queuedBytes -= bytes;
+        queuedMicros -= toMicros(seconds);
+
+        // Publie la libération avant de lire le drapeau du producteur
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(waitMutex);
+            waitCondition.notify_all();
+        }
+    }
+
+    // Producteur uniquement : false si le délai expire ou si interrupt() est appelé
+    template <typename Rep, typename Period>
+    bool waitForRoom(std::chrono::duration<Rep, Period> timeout) {
+        if (!throttled) {
+            if (!aboveHighWatermark()) {
+                return true;
+            }
+            throttled = true;
+        }
+
+        std::unique_lock<std::mutex> lock(waitMutex);
+        producerWaiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        waitCondition.wait_for(lock, timeout, [this] {
+            return belowLowWatermark() || interrupted;
+        });
+        producerWaiting.store(false, std::memory_order_relaxed);
+
+        if (belowLowWatermark()) {
+            throttled = false;
+        }
+        return !throttled;
+    }
+
+    void interrupt() {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        interrupted = true;
+        waitCondition.notify_all();
+    }
+
+    void resume() {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        interrupted = false;
+    }
+
+    size_t bytes() const { return queuedBytes; }
+    double seconds() const { return queuedMicros / 1e6; }
+
+private:
+    static int64_t toMicros(double seconds) { return static_cast<int64_t>(seconds * 1e6); }
+
+    bool aboveHighWatermark() const {
+        return queuedBytes >= limits.maxBytes || seconds() >= limits.maxSeconds;
+    }
+
+    // Une file vide accepte toujours un élément, même plus gros que le budget
+    bool belowLowWatermark() const {
+        if (queuedBytes == 0) {
+            return true;
+        }
+        return queuedBytes < limits.maxBytes * limits.lowWatermark &&
+               seconds() < limits.maxSeconds * limits.lowWatermark;
+    }
+
+    QueueLimits limits;
+    std::atomic<size_t> queuedBytes;
+    std::atomic<int64_t> queuedMicros;
+    bool throttled;  // état d'hystérésis, propre au producteur
+    std::atomic<bool> producerWaiting;
+    bool interrupted;
+    std::mutex waitMutex;
+    std::condition_variable waitCondition;
+};
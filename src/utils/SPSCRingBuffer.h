@@ -0,0 +1,152 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// File bornée single-producer/single-consumer sans verrou.
+// tryPush/tryPop ne prennent jamais de verrou. waitPush/waitPop permettent de dormir
+// au lieu de sonder : le mutex n'est pris que lorsqu'un côté doit réellement attendre.
+template <typename T>
+class SPSCRingBuffer {
+public:
+    explicit SPSCRingBuffer(size_t capacity)
+        : maxItems(capacity)
+        , mask(roundUpToPowerOfTwo(capacity) - 1)
+        , slots(mask + 1)
+        , head(0)
+        , cachedTail(0)
+        , tail(0)
+        , cachedHead(0)
+        , consumerWaiting(false)
+        , producerWaiting(false)
+        , interrupted(false) {
+    }
+
+    SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+    SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+    // Producteur uniquement
+    bool tryPush(const T& item) {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - cachedHead >= maxItems) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (currentTail - cachedHead >= maxItems) {
+                return false;
+            }
+        }
+
+        slots[currentTail & mask] = item;
+        tail.store(currentTail + 1, std::memory_order_release);
+        wakeIfWaiting(consumerWaiting);
+        return true;
+    }
+
+    // Consommateur uniquement
+    bool tryPop(T& item) {
+        const size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (currentHead == cachedTail) {
+                return false;
+            }
+        }
+
+        item = slots[currentHead & mask];
+        head.store(currentHead + 1, std::memory_order_release);
+        wakeIfWaiting(producerWaiting);
+        return true;
+    }
+
+    // Bloque jusqu'à ce qu'une place se libère, l'expiration du délai ou interrupt()
+    template <typename Rep, typename Period>
+    bool waitPush(const T& item, std::chrono::duration<Rep, Period> timeout) {
+        if (tryPush(item)) {
+            return true;
+        }
+        return waitFor(producerWaiting, timeout, [&] { return tryPush(item); });
+    }
+
+    // Bloque jusqu'à l'arrivée d'un élément, l'expiration du délai ou interrupt()
+    template <typename Rep, typename Period>
+    bool waitPop(T& item, std::chrono::duration<Rep, Period> timeout) {
+        if (tryPop(item)) {
+            return true;
+        }
+        return waitFor(consumerWaiting, timeout, [&] { return tryPop(item); });
+    }
+
+    // Réveille les threads en attente et fait échouer les attentes suivantes
+    void interrupt() {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        interrupted = true;
+        waitCondition.notify_all();
+    }
+
+    void resume() {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        interrupted = false;
+    }
+
+    // Approximatif lorsqu'appelé depuis un troisième thread
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return maxItems; }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    template <typename Rep, typename Period, typename Attempt>
+    bool waitFor(std::atomic<bool>& waitingFlag, std::chrono::duration<Rep, Period> timeout, Attempt attempt) {
+        std::unique_lock<std::mutex> lock(waitMutex);
+        bool done = false;
+        waitingFlag.store(true, std::memory_order_relaxed);
+        // Ordonne la publication du drapeau avant la relecture de l'index de l'autre côté
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        waitCondition.wait_for(lock, timeout, [&] {
+            done = attempt();
+            return done || interrupted;
+        });
+        waitingFlag.store(false, std::memory_order_relaxed);
+        return done;
+    }
+
+    void wakeIfWaiting(std::atomic<bool>& waitingFlag) {
+        // Pendant de la barrière de waitFor : l'index est publié avant de lire le drapeau
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waitingFlag.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(waitMutex);
+            waitCondition.notify_all();
+        }
+    }
+
+    const size_t maxItems;
+    const size_t mask;
+    std::vector<T> slots;
+
+    // Index du consommateur et sa copie locale de l'index producteur
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;
+    size_t cachedTail;
+
+    // Index du producteur et sa copie locale de l'index consommateur
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;
+    size_t cachedHead;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> consumerWaiting;
+    std::atomic<bool> producerWaiting;
+    bool interrupted;
+    std::mutex waitMutex;
+    std::condition_variable waitCondition;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Logger.h"
+
+// Chronologie du démarrage : chaque phase est enregistrée avec son début et sa durée,
+// depuis n'importe quel thread, puis journalisée d'un bloc à la première frame présentée.
+class StartupTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    StartupTimeline() : origin(Clock::now()) {}
+
+    // Phase commencée à start et terminée maintenant
+    void record(const std::string& name, Clock::time_point start) {
+        std::lock_guard<std::mutex> lock(mutex);
+        phases.push_back({name, start, Clock::now()});
+    }
+
+    void report() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Phase> sorted = phases;
+        std::sort(sorted.begin(), sorted.end(), [](const Phase& a, const Phase& b) { return a.start < b.start; });
+
+        std::string report = "Startup timeline:";
+        for (const Phase& phase : sorted) {
+            report += "\n  +" + std::to_string(milliseconds(phase.start - origin)) + " ms  " + phase.name +
+                      ": " + std::to_string(milliseconds(phase.end - phase.start)) + " ms";
+        }
+        report += "\n  first frame after " + std::to_string(milliseconds(Clock::now() - origin)) + " ms";
+        Logger::logPerformance(report);
+    }
+
+private:
+    struct Phase {
+        std::string name;
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+
+    static long long milliseconds(Clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+
+    const Clock::time_point origin;
+    std::vector<Phase> phases;
+    mutable std::mutex mutex;
+};
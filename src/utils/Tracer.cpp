@@ -0,0 +1,192 @@
+#include "Tracer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Tracer::enabled(false);
+std::atomic<bool> Tracer::dumpRequested(false);
+
+namespace {
+
+// Champs atomiques : l'export lit pendant que le thread propriétaire écrit
+struct TraceSlot {
+    std::atomic<const char*> name;
+    std::atomic<int64_t> startNs;
+    std::atomic<int64_t> durationNs;
+    std::atomic<int64_t> pts;
+};
+
+struct TraceEvent {
+    const char* name;
+    int64_t startNs;
+    int64_t durationNs;
+    int64_t pts;
+};
+
+}  // namespace
+
+// Anneau d'un thread : un seul écrivain, lu par l'export
+class ThreadTrace {
+public:
+    ThreadTrace(int id, const std::string& name)
+        : id(id)
+        , name(name)
+        , slots(new TraceSlot[CAPACITY])
+        , count(0) {
+    }
+
+    void record(const TraceEvent& event) {
+        uint64_t index = count.load(std::memory_order_relaxed);
+        TraceSlot& slot = slots[index & (CAPACITY - 1)];
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.startNs.store(event.startNs, std::memory_order_relaxed);
+        slot.durationNs.store(event.durationNs, std::memory_order_relaxed);
+        slot.pts.store(event.pts, std::memory_order_relaxed);
+        count.store(index + 1, std::memory_order_release);
+    }
+
+    // Copie les spans commencés après sinceNs ; ceux que l'écrivain a pu écraser pendant la copie sont écartés
+    void collect(int64_t sinceNs, std::vector<TraceEvent>& events) const {
+        uint64_t end = count.load(std::memory_order_acquire);
+        uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+        size_t first = events.size();
+        for (uint64_t index = begin; index < end; index++) {
+            const TraceSlot& slot = slots[index & (CAPACITY - 1)];
+            events.push_back({slot.name.load(std::memory_order_relaxed), slot.startNs.load(std::memory_order_relaxed),
+                              slot.durationNs.load(std::memory_order_relaxed), slot.pts.load(std::memory_order_relaxed)});
+        }
+        // L'écrivain a pu réécrire les cases jusqu'à celle du span suivant le dernier publié
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t reusedEnd = count.load(std::memory_order_relaxed) + 1;
+        reusedEnd = reusedEnd > CAPACITY ? reusedEnd - CAPACITY : 0;
+        size_t unsafe = static_cast<size_t>(reusedEnd > begin ? std::min(reusedEnd - begin, end - begin) : 0);
+        events.erase(events.begin() + first, events.begin() + first + unsafe);
+        events.erase(std::remove_if(events.begin() + first, events.end(),
+                                    [sinceNs](const TraceEvent& event) { return event.startNs < sinceNs; }),
+                     events.end());
+    }
+
+    const int id;
+    std::string name;
+
+private:
+    // Environ 20 s de spans pour un thread de décodage 4K60 qui en produit une dizaine par frame
+    static constexpr uint64_t CAPACITY = 16384;
+
+    std::unique_ptr<TraceSlot[]> slots;
+    std::atomic<uint64_t> count;
+};
+
+namespace {
+
+// Les anneaux survivent à leur thread pour rester exportables
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadTrace>> registry;
+
+// Types triviaux : aucun destructeur de thread à enregistrer au premier accès
+thread_local ThreadTrace* currentTrace = nullptr;
+thread_local char currentThreadName[64] = "";
+
+ThreadTrace* registerThreadTrace(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    int id = static_cast<int>(registry.size()) + 1;
+    registry.emplace_back(new ThreadTrace(id, name.empty() ? "thread " + std::to_string(id) : name));
+    return registry.back().get();
+}
+
+ThreadTrace& currentThreadTrace() {
+    if (!currentTrace) {
+        currentTrace = registerThreadTrace(currentThreadName);
+    }
+    return *currentTrace;
+}
+
+int64_t toNanoseconds(Tracer::Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+}  // namespace
+
+void Tracer::setThreadName(const std::string& name) {
+    // Conservé pour l'anneau, créé au premier span
+    snprintf(currentThreadName, sizeof(currentThreadName), "%s", name.c_str());
+    if (currentTrace) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        currentTrace->name = name;
+    }
+}
+
+ThreadTrace* Tracer::createThreadTrace(const std::string& name) {
+    return isEnabled() ? registerThreadTrace(name) : nullptr;
+}
+
+void Tracer::adoptThreadTrace(ThreadTrace* trace) {
+    if (!currentTrace) {
+        currentTrace = trace;
+    }
+}
+
+void Tracer::record(const char* name, Clock::time_point start, Clock::time_point end, int64_t pts) {
+    // Premier span du thread : enregistrement de son anneau, une seule fois
+    currentThreadTrace().record({name, toNanoseconds(start), toNanoseconds(end) - toNanoseconds(start), pts});
+}
+
+bool Tracer::dump(const std::string& path, double seconds) {
+    int64_t now = toNanoseconds(Clock::now());
+    int64_t since = now - static_cast<int64_t>(seconds * 1e9);
+
+    std::ofstream file(path);
+    if (!file) {
+        Logger::logError("Could not write trace to " + path);
+        return false;
+    }
+
+    // Format JSON Object de Chrome : spans complets ("X") en microsecondes, un tid par thread
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    size_t spanCount = 0;
+    std::vector<TraceEvent> events;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const std::unique_ptr<ThreadTrace>& trace : registry) {
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trace->id
+             << ",\"args\":{\"name\":\"" << escapeJson(trace->name) << "\"}}";
+        first = false;
+
+        events.clear();
+        trace->collect(since, events);
+        for (const TraceEvent& event : events) {
+            char line[256];
+            snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                     event.name, trace->id, (event.startNs - since) / 1000.0, event.durationNs / 1000.0);
+            file << line;
+            if (event.pts != NO_PTS) {
+                file << ",\"args\":{\"pts\":" << event.pts << "}";
+            }
+            file << "}";
+        }
+        spanCount += events.size();
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        Logger::logError("Could not write trace to " + path);
+        return false;
+    }
+    Logger::logInfo("Trace of the last " + std::to_string(static_cast<int>(seconds)) + " s written to " + path +
+                    " (" + std::to_string(spanCount) + " spans)");
+    return true;
+}
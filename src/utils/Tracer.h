@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+class ThreadTrace;
+
+// Traces de pipeline par frame : chaque thread enregistre ses spans dans son propre anneau
+// (sans verrou, les plus anciens sont écrasés), étiquetés avec le PTS de la frame. Un export
+// au format Chrome trace-event (chrome://tracing, Perfetto) couvre les dernières secondes.
+// Désactivé, un span ne coûte qu'une lecture atomique et aucun anneau n'est alloué.
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+    // Span sans frame associée (même valeur que AV_NOPTS_VALUE)
+    static constexpr int64_t NO_PTS = std::numeric_limits<int64_t>::min();
+
+    static void setEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    // Nom du thread courant dans la trace ; à appeler au début du thread.
+    // L'anneau n'est créé qu'au premier span enregistré
+    static void setThreadName(const std::string& name);
+    // Anneau créé d'avance pour un thread temps réel, qui ne doit ni verrouiller ni allouer ;
+    // nullptr si le traçage est désactivé. L'anneau vit jusqu'à la fin du programme
+    static ThreadTrace* createThreadTrace(const std::string& name);
+    // Depuis le thread temps réel : adopte l'anneau créé d'avance, sans verrou ni allocation
+    static void adoptThreadTrace(ThreadTrace* trace);
+    static void record(const char* name, Clock::time_point start, Clock::time_point end, int64_t pts);
+
+    // Écrit les spans des seconds dernières secondes ; sûr depuis n'importe quel thread
+    static bool dump(const std::string& path, double seconds);
+    // Depuis un gestionnaire de signal : seule une écriture atomique
+    static void requestDump() { dumpRequested.store(true, std::memory_order_relaxed); }
+    static bool consumeDumpRequest() { return dumpRequested.exchange(false, std::memory_order_relaxed); }
+
+private:
+    static std::atomic<bool> enabled;
+    static std::atomic<bool> dumpRequested;
+};
+
+// Span couvrant la portée ; le PTS peut être fixé une fois connu (frame décodée)
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, int64_t pts = Tracer::NO_PTS)
+        : name(Tracer::isEnabled() ? name : nullptr)
+        , pts(pts) {
+        if (this->name) {
+            start = Tracer::Clock::now();
+        }
+    }
+
+    ~TraceScope() {
+        if (name) {
+            Tracer::record(name, start, Tracer::Clock::now(), pts);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void setPts(int64_t framePts) { pts = framePts; }
+
+private:
+    const char* name;  // nullptr : traçage désactivé à l'ouverture
+    int64_t pts;
+    Tracer::Clock::time_point start;
+};